@@ -0,0 +1,672 @@
+/*
+ ==============================================================================
+ Main.cpp
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+// Headless benchmark of StereoCreatorAudioProcessor. Every stereo mode is run with two and four
+// inputs, at block sizes from 16 to 4096 samples, with static parameters and with parameters
+// automated every block, in single and in double precision.
+//
+// usage: StereoCreatorBenchmark [--seconds <audio seconds per run>] [--precision <single|double>] [--save <file>] [--compare <file>]
+//
+// --precision restricts the runs to single or double precision buffers, both are run by default.
+// --save writes the results to a file, --compare prints the change against a file written by an
+// earlier build, so regressions between releases show up.
+//
+// usage: StereoCreatorBenchmark --verify
+//
+// --verify checks instead that every vectorised kernel the CPU supports matches the scalar path within
+// 1e-6, on its own and inside the processor at block sizes that leave a scalar tail. It returns 1 if not.
+//
+// usage: StereoCreatorBenchmark --editors <count> [--save <file>] [--compare <file>]
+//
+// --editors opens the given number of editors and keeps them open, as a session with many instances does,
+// and prints the time to open and paint an editor and the resident memory it adds. The first editor is
+// listed on its own, as it builds the caches shared by all editors.
+//
+// Debug builds assert if the processor allocates inside processBlock, see AllocationCheck.h.
+
+#include <JuceHeader.h>
+#include <iostream>
+#if JUCE_LINUX
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/AllocationCheck.h"
+
+#if STEREOCREATOR_CHECK_ALLOCATIONS
+// the processor only marks the scope of processBlock, this binary replaces the global operator new to
+// assert when something allocates in it. The plug-in leaves the host's allocator alone
+void* operator new (std::size_t size)
+{
+    if (AllocationCheck::isForbidden())
+    {
+        AllocationCheck::isForbidden() = false; // the assertion itself might allocate
+        jassertfalse; // allocating on the audio thread
+    }
+    
+    if (void* ptr = std::malloc (size != 0 ? size : 1))
+        return ptr;
+    
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                 { return operator new (size); }
+void operator delete (void* ptr) noexcept               { std::free (ptr); }
+void operator delete[] (void* ptr) noexcept             { std::free (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept  { std::free (ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept { std::free (ptr); }
+#endif
+
+namespace
+{
+    const double sampleRate = 48000.0;
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const char* const modeNames[] = { "Pseudo-MS", "Pseudo-Stereo", "True-MS", "True-Stereo", "Blumlein" };
+    
+    struct BenchmarkResult
+    {
+        String name;
+        double nsPerFrame;
+        double cyclesPerFrame;
+        double realtimeFactor;
+    };
+    
+    struct EditorResult
+    {
+        String name;
+        double value;
+    };
+    
+    RangedAudioParameter* findParameter (AudioProcessor& processor, const String& parameterID)
+    {
+        for (auto* parameter : processor.getParameters())
+            if (auto* ranged = dynamic_cast<RangedAudioParameter*> (parameter))
+                if (ranged->paramID == parameterID)
+                    return ranged;
+        
+        jassertfalse;
+        return nullptr;
+    }
+    
+    void setParameter (AudioProcessor& processor, const String& parameterID, float value)
+    {
+        auto* parameter = findParameter (processor, parameterID);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+    
+    // changes only the main buses, the output buses of the single modes stay disabled. A layout the processor
+    // rejects would leave the previous one in place and measure something else, so it ends the benchmark
+    void setMainBusLayout (AudioProcessor& processor, int numInputChannels, int numOutputChannels)
+    {
+        const auto getChannelSet = [] (int numChannels)
+        {
+            if (numChannels == 2)
+                return AudioChannelSet::stereo();
+            
+            if (numChannels == 4)
+                return AudioChannelSet::quadraphonic();
+            
+            return AudioChannelSet::discreteChannels (numChannels);
+        };
+        
+        AudioProcessor::BusesLayout layout = processor.getBusesLayout();
+        layout.inputBuses.getReference (0) = getChannelSet (numInputChannels);
+        layout.outputBuses.getReference (0) = getChannelSet (numOutputChannels);
+        
+        if (! processor.setBusesLayout (layout))
+        {
+            std::cerr << "the processor doesn't support " << numInputChannels << " inputs and "
+                      << numOutputChannels << " outputs" << std::endl;
+            std::exit (1);
+        }
+    }
+    
+    // sweeps every parameter the matrix depends on, so each block ramps to a new matrix
+    void automateParameters (AudioProcessor& processor, int blockIndex)
+    {
+        const float phase = 0.5f + 0.5f * std::sin (0.05f * blockIndex);
+        
+        setParameter (processor, "msMidGain", -18.0f + 21.0f * phase);
+        setParameter (processor, "msSideGain", 3.0f - 21.0f * phase);
+        setParameter (processor, "pseudoStPattern", 0.75f * phase);
+        setParameter (processor, "msMidPattern", 0.75f * (1.0f - phase));
+        setParameter (processor, "trueStXyPattern", 0.37f + 0.38f * phase);
+        setParameter (processor, "trueStXyAngle", 30.0f + 120.0f * phase);
+        setParameter (processor, "blumleinRot", -30.0f + 60.0f * phase);
+    }
+    
+    template <typename FloatType>
+    BenchmarkResult runBenchmark (int stereoMode, int numInputChannels, int blockSize, bool automated, double secondsOfAudio)
+    {
+        StereoCreatorAudioProcessor processor;
+        
+        setMainBusLayout (processor, numInputChannels, 2);
+        processor.setProcessingPrecision (std::is_same<FloatType, double>::value ? AudioProcessor::doublePrecision
+                                                                                  : AudioProcessor::singlePrecision);
+        
+        processor.prepareToPlay (sampleRate, blockSize);
+        // set after prepareToPlay, which would move modes that don't fit the input to one that does
+        setParameter (processor, "stereoMode", (float) stereoMode);
+        
+        const int numChannels = jmax (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        AudioBuffer<FloatType> input (numChannels, blockSize);
+        AudioBuffer<FloatType> buffer (numChannels, blockSize);
+        MidiBuffer midi;
+        
+        Random random (0x5c);
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                input.setSample (ch, i, (FloatType) (0.5f * (2.0f * random.nextFloat() - 1.0f)));
+        
+        const int numBlocks = jmax (1, (int) (secondsOfAudio * sampleRate / blockSize));
+        const int numWarmUpBlocks = jmax (1, numBlocks / 10);
+        int64 ticks = 0;
+        
+        for (int block = -numWarmUpBlocks; block < numBlocks; ++block)
+        {
+            if (automated)
+                automateParameters (processor, block);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.copyFrom (ch, 0, input, ch, 0, blockSize);
+            
+            const int64 start = Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            const int64 end = Time::getHighResolutionTicks();
+            
+            if (block >= 0)
+                ticks += end - start;
+        }
+        
+        processor.releaseResources();
+        
+        const double seconds = Time::highResolutionTicksToSeconds (ticks);
+        const double numFrames = (double) numBlocks * blockSize;
+        
+        BenchmarkResult result;
+        result.name = String (modeNames[stereoMode - 1]) + " " + String (numInputChannels) + "ch "
+                      + String (blockSize) + (automated ? " automated" : " static");
+        
+        if (std::is_same<FloatType, double>::value)
+            result.name << " double";
+        
+        // the true modes pass left/right through with two inputs
+        if (numInputChannels == 2 && stereoMode >= trueMsIdx)
+            result.name << " passthrough";
+        result.nsPerFrame = 1.0e9 * seconds / numFrames;
+        // based on the nominal clock, turbo and power saving are not taken into account
+        result.cyclesPerFrame = result.nsPerFrame * SystemStats::getCpuSpeedInMegahertz() / 1000.0;
+        result.realtimeFactor = seconds > 0.0 ? numFrames / sampleRate / seconds : 0.0;
+        return result;
+    }
+    
+    //==============================================================================
+    // the largest difference of a vectorised kernel's output to the scalar path
+    const float maxKernelDifference = 1.0e-6f;
+    
+    struct VectorisedKernels
+    {
+        String name;
+        MixingKernels::FourChannelKernel fourChannelKernel;
+        MixingKernels::MatrixKernel matrixKernel;
+    };
+    
+    // every instruction set the CPU supports, not only the widest one the processor picks
+    Array<VectorisedKernels> getVectorisedKernels()
+    {
+        Array<VectorisedKernels> kernels;
+        
+       #if JUCE_INTEL
+        if (SystemStats::hasSSE2())
+            kernels.add (VectorisedKernels { "SSE2", MixingKernels::mixFourChannelsSse, MixingKernels::mixMatrixSse });
+        
+        if (SystemStats::hasAVX())
+            kernels.add (VectorisedKernels { "AVX", MixingKernels::mixFourChannelsAvx, MixingKernels::mixMatrixAvx });
+       #elif JUCE_USE_ARM_NEON || defined (__ARM_NEON) || defined (__ARM_NEON__)
+        kernels.add (VectorisedKernels { "NEON", MixingKernels::mixFourChannelsNeon, MixingKernels::mixMatrixNeon });
+       #endif
+        
+        return kernels;
+    }
+    
+    // the scalar loop of the processor's four channel tiles, with the levels summed in double
+    void mixFourChannelsScalar (float* const* channels, int numFrames, const MixingRamp& ramp, double* sumsOfSquares, float* peaks)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            const float position = (float) (ramp.position + i);
+            const float gain = ramp.startGain + ramp.gainIncrement * position;
+            
+            float output[2];
+            for (int out = 0; out < 2; ++out)
+            {
+                float sum = (ramp.start.gains[out][0] + ramp.increment.gains[out][0] * position) * channels[0][i];
+                for (int in = 1; in < 4; ++in)
+                    sum += (ramp.start.gains[out][in] + ramp.increment.gains[out][in] * position) * channels[in][i];
+                
+                output[out] = gain * sum;
+            }
+            
+            for (int in = 0; in < 4; ++in)
+            {
+                sumsOfSquares[in] += channels[in][i] * channels[in][i];
+                peaks[in] = jmax (peaks[in], std::abs (channels[in][i]));
+            }
+            for (int out = 0; out < 2; ++out)
+            {
+                sumsOfSquares[4 + out] += output[out] * output[out];
+                peaks[4 + out] = jmax (peaks[4 + out], std::abs (output[out]));
+            }
+            
+            channels[0][i] = output[0];
+            channels[1][i] = output[1];
+            channels[2][i] = 0.0f;
+            channels[3][i] = 0.0f;
+        }
+    }
+    
+    // the scalar loop of the processor's virtual microphone tiles
+    void mixMatrixScalar (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            const float position = (float) (ramp.position + i);
+            
+            for (int out = 0; out < numOutputs; ++out)
+            {
+                float sum = 0.0f;
+                for (int in = 0; in < numInputs; ++in)
+                    sum += (ramp.start.gains[out][in] + ramp.increment.gains[out][in] * position) * inputs[in][i];
+                
+                outputs[out][i] = sum;
+            }
+        }
+    }
+    
+    float getRandomSample (Random& random)
+    {
+        return 2.0f * random.nextFloat() - 1.0f;
+    }
+    
+    float getMaxDifference (const AudioBuffer<float>& a, const AudioBuffer<float>& b)
+    {
+        float maxDifference = 0.0f;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                maxDifference = jmax (maxDifference, std::abs (a.getSample (ch, i) - b.getSample (ch, i)));
+        
+        return maxDifference;
+    }
+    
+    // random ramps over whole iterations, the kernels don't have a tail of their own
+    bool verifyFourChannelKernel (const VectorisedKernels& kernels, Random& random)
+    {
+        const int numFrames[] = { 8, 64, 8 * 37 };
+        float maxDifference = 0.0f;
+        float maxLevelError = 0.0f;
+        
+        for (int trial = 0; trial < 100; ++trial)
+        {
+            const int frames = numFrames[trial % numElementsInArray (numFrames)];
+            
+            MixingRamp ramp;
+            for (int out = 0; out < 2; ++out)
+            {
+                for (int in = 0; in < 4; ++in)
+                {
+                    ramp.start.gains[out][in] = 1.5f * getRandomSample (random);
+                    ramp.increment.gains[out][in] = 0.01f * getRandomSample (random);
+                }
+            }
+            ramp.startGain = 2.0f * random.nextFloat();
+            ramp.gainIncrement = 0.01f * getRandomSample (random);
+            ramp.position = random.nextInt (64);
+            
+            AudioBuffer<float> expected (4, frames);
+            for (int ch = 0; ch < 4; ++ch)
+                for (int i = 0; i < frames; ++i)
+                    expected.setSample (ch, i, 0.5f * getRandomSample (random));
+            
+            AudioBuffer<float> actual (expected);
+            
+            double sumsOfSquares[6] = {};
+            float peaks[6] = {};
+            mixFourChannelsScalar (expected.getArrayOfWritePointers(), frames, ramp, sumsOfSquares, peaks);
+            
+            BlockLevels levels = BlockLevels();
+            kernels.fourChannelKernel (actual.getArrayOfWritePointers(), frames, ramp, levels);
+            
+            maxDifference = jmax (maxDifference, getMaxDifference (expected, actual));
+            
+            // the sums of squares are added up in a different order, so they are compared relatively
+            for (int ch = 0; ch < 6; ++ch)
+            {
+                const float sumOfSquares = ch < 4 ? levels.inputSumOfSquares[ch] : levels.outputSumOfSquares[ch - 4];
+                const float peak = ch < 4 ? levels.inputPeak[ch] : levels.outputPeak[ch - 4];
+                maxLevelError = jmax (maxLevelError, (float) std::abs (sumOfSquares / (sumsOfSquares[ch] + 1.0e-20) - 1.0),
+                                      std::abs (peak - peaks[ch]));
+            }
+        }
+        
+        const bool passed = maxDifference <= maxKernelDifference && maxLevelError <= 1.0e-5f;
+        std::cout << (kernels.name + " four channel kernel").paddedRight (' ', 52) << "max difference " << maxDifference
+                  << ", max level error " << maxLevelError << (passed ? "" : "  FAILED") << std::endl;
+        return passed;
+    }
+    
+    bool verifyMatrixKernel (const VectorisedKernels& kernels, Random& random)
+    {
+        float maxDifference = 0.0f;
+        
+        for (int trial = 0; trial < 100; ++trial)
+        {
+            const int numInputs = 2 * (1 + random.nextInt (VirtualMicMatrix::maxInputs / 2));
+            const int numOutputs = 1 + random.nextInt (VirtualMicMatrix::maxOutputs);
+            const int frames = 8 * (1 + random.nextInt (37));
+            
+            VirtualMicRamp ramp;
+            for (int out = 0; out < numOutputs; ++out)
+            {
+                for (int in = 0; in < numInputs; ++in)
+                {
+                    ramp.start.gains[out][in] = getRandomSample (random);
+                    ramp.increment.gains[out][in] = 0.01f * getRandomSample (random);
+                }
+            }
+            ramp.position = random.nextInt (64);
+            
+            AudioBuffer<float> inputs (numInputs, frames);
+            for (int ch = 0; ch < numInputs; ++ch)
+                for (int i = 0; i < frames; ++i)
+                    inputs.setSample (ch, i, 0.5f * getRandomSample (random));
+            
+            AudioBuffer<float> expected (numOutputs, frames);
+            AudioBuffer<float> actual (numOutputs, frames);
+            mixMatrixScalar (inputs.getArrayOfReadPointers(), numInputs, expected.getArrayOfWritePointers(), numOutputs, frames, ramp);
+            kernels.matrixKernel (inputs.getArrayOfReadPointers(), numInputs, actual.getArrayOfWritePointers(), numOutputs, frames, ramp);
+            
+            maxDifference = jmax (maxDifference, getMaxDifference (expected, actual));
+        }
+        
+        const bool passed = maxDifference <= maxKernelDifference;
+        std::cout << (kernels.name + " matrix kernel").paddedRight (' ', 52) << "max difference " << maxDifference
+                  << (passed ? "" : "  FAILED") << std::endl;
+        return passed;
+    }
+    
+    // the same input and automation through a processor with and without the vectorised kernels. The tiles of
+    // the block sizes leave a scalar tail after the last whole iteration
+    bool verifyProcessor (int stereoMode, bool virtualMics, int numInputChannels, int numOutputChannels, int blockSize)
+    {
+        StereoCreatorAudioProcessor vectorisedProcessor, scalarProcessor;
+        scalarProcessor.setVectorisedKernelsEnabled (false);
+        StereoCreatorAudioProcessor* processors[2] = { &vectorisedProcessor, &scalarProcessor };
+        
+        for (auto* processor : processors)
+        {
+            setMainBusLayout (*processor, numInputChannels, numOutputChannels);
+            processor->prepareToPlay (sampleRate, blockSize);
+            setParameter (*processor, "stereoMode", (float) stereoMode);
+            setParameter (*processor, "virtualMics", virtualMics ? 1.0f : 0.0f);
+        }
+        
+        const int numChannels = jmax (vectorisedProcessor.getTotalNumInputChannels(), vectorisedProcessor.getTotalNumOutputChannels());
+        AudioBuffer<float> buffers[2] = { AudioBuffer<float> (numChannels, blockSize), AudioBuffer<float> (numChannels, blockSize) };
+        MidiBuffer midi;
+        Random random (0x3d);
+        float maxDifference = 0.0f;
+        
+        for (int block = 0; block < 100; ++block)
+        {
+            buffers[0].clear();
+            for (int ch = 0; ch < numInputChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffers[0].setSample (ch, i, 0.5f * getRandomSample (random));
+            
+            buffers[1].makeCopyOf (buffers[0], true);
+            
+            for (int p = 0; p < 2; ++p)
+            {
+                automateParameters (*processors[p], block);
+                processors[p]->processBlock (buffers[p], midi);
+            }
+            
+            maxDifference = jmax (maxDifference, getMaxDifference (buffers[0], buffers[1]));
+        }
+        
+        for (auto* processor : processors)
+            processor->releaseResources();
+        
+        const String name = virtualMics ? "Virtual Mics" : modeNames[stereoMode - 1];
+        const bool passed = maxDifference <= maxKernelDifference;
+        std::cout << (name + " " + String (numInputChannels) + "x" + String (numOutputChannels) + " processor " + String (blockSize)).paddedRight (' ', 52)
+                  << "max difference " << maxDifference << (passed ? "" : "  FAILED") << std::endl;
+        return passed;
+    }
+    
+    bool verifyKernels()
+    {
+        bool passed = true;
+        Random random (0x9d);
+        
+        const auto kernels = getVectorisedKernels();
+        if (kernels.isEmpty())
+            std::cout << "no vectorised kernels for this CPU" << std::endl;
+        
+        for (auto& kernel : kernels)
+        {
+            passed = verifyFourChannelKernel (kernel, random) && passed;
+            passed = verifyMatrixKernel (kernel, random) && passed;
+        }
+        
+        // the processor uses the widest kernel, none of these block sizes is a multiple of the iteration
+        const int tailBlockSizes[] = { 1, 13, 61, 100, 509 };
+        for (auto blockSize : tailBlockSizes)
+        {
+            for (int stereoMode = pseudoMsIdx; stereoMode <= blumleinIdx; ++stereoMode)
+                passed = verifyProcessor (stereoMode, false, 4, 2, blockSize) && passed;
+            
+            passed = verifyProcessor (pseudoMsIdx, true, 4, 4, blockSize) && passed;
+            passed = verifyProcessor (pseudoMsIdx, true, 8, 8, blockSize) && passed;
+        }
+        
+        std::cout << std::endl << (passed ? "all kernels match the scalar path" : "kernels don't match the scalar path") << std::endl;
+        jassert (passed);
+        return passed;
+    }
+    
+    // resident set size of the process in bytes, 0 where it can't be read
+    int64 getResidentMemory()
+    {
+       #if JUCE_LINUX
+        const auto statm = StringArray::fromTokens (File ("/proc/self/statm").loadFileAsString(), false);
+        return statm.size() > 1 ? statm[1].getLargeIntValue() * (int64) sysconf (_SC_PAGESIZE) : 0;
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info (mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS)
+            return (int64) info.resident_size;
+        return 0;
+       #else
+        return 0;
+       #endif
+    }
+    
+    // the processors are created before the clock starts, so only the editor and its first paint are measured
+    Array<EditorResult> measureEditors (int numEditors)
+    {
+        OwnedArray<StereoCreatorAudioProcessor> processors;
+        OwnedArray<AudioProcessorEditor> editors;
+        double firstMs = 0.0, furtherMs = 0.0;
+        int64 firstBytes = 0, furtherBytes = 0;
+        
+        for (int i = 0; i < numEditors; ++i)
+            processors.add (new StereoCreatorAudioProcessor());
+        
+        for (auto* processor : processors)
+        {
+            const int64 memoryBefore = getResidentMemory();
+            const double startMs = Time::getMillisecondCounterHiRes();
+            
+            auto* editor = editors.add (processor->createEditor());
+            Image image (Image::ARGB, editor->getWidth(), editor->getHeight(), true);
+            Graphics g (image);
+            editor->paintEntireComponent (g, false);
+            
+            const double elapsedMs = Time::getMillisecondCounterHiRes() - startMs;
+            const int64 addedBytes = getResidentMemory() - memoryBefore;
+            
+            if (editors.size() == 1)
+            {
+                firstMs = elapsedMs;
+                firstBytes = addedBytes;
+            }
+            else
+            {
+                furtherMs += elapsedMs;
+                furtherBytes += addedBytes;
+            }
+        }
+        
+        const int numFurther = jmax (1, numEditors - 1);
+        Array<EditorResult> results;
+        results.add ({ "editor open, first (ms)", firstMs });
+        results.add ({ "editor open, each further (ms)", furtherMs / numFurther });
+        results.add ({ "resident memory, first editor (KiB)", (double) firstBytes / 1024.0 });
+        results.add ({ "resident memory, each further editor (KiB)", (double) furtherBytes / 1024.0 / numFurther });
+        return results;
+    }
+    
+    // the change against a value of the same name in an earlier run, or an empty string if there is none
+    String getChange (const StringPairArray& baseline, const String& name, double value)
+    {
+        const String baselineValue = baseline.getValue (name, String());
+        if (baselineValue.isEmpty() || baselineValue.getDoubleValue() <= 0.0)
+            return {};
+        
+        const double change = 100.0 * (value / baselineValue.getDoubleValue() - 1.0);
+        return (String (change > 0.0 ? "+" : "") + String (change, 1) + " %").paddedLeft (' ', 10);
+    }
+    
+    StringPairArray loadResults (const File& file)
+    {
+        StringPairArray results;
+        StringArray lines;
+        file.readLines (lines);
+        
+        for (auto& line : lines)
+            if (line.containsChar (','))
+                results.set (line.upToLastOccurrenceOf (",", false, false), line.fromLastOccurrenceOf (",", false, false));
+        
+        return results;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    ArgumentList arguments (argc, argv);
+    
+    if (arguments.containsOption ("--verify"))
+        return verifyKernels() ? 0 : 1;
+    
+    const double secondsOfAudio = arguments.containsOption ("--seconds") ? arguments.getValueForOption ("--seconds").getDoubleValue() : 10.0;
+    const File saveFile = arguments.containsOption ("--save") ? arguments.getFileForOption ("--save") : File();
+    const File compareFile = arguments.containsOption ("--compare") ? arguments.getFileForOption ("--compare") : File();
+    const String precision = arguments.containsOption ("--precision") ? arguments.getValueForOption ("--precision") : String();
+    
+    if (precision.isNotEmpty() && precision != "single" && precision != "double")
+    {
+        std::cerr << "--precision is single or double" << std::endl;
+        return 1;
+    }
+    
+    const StringPairArray baseline = compareFile.existsAsFile() ? loadResults (compareFile) : StringPairArray();
+    StringArray savedLines;
+    
+    if (arguments.containsOption ("--editors"))
+    {
+        const int numEditors = arguments.getValueForOption ("--editors").getIntValue();
+        if (numEditors < 1)
+        {
+            std::cerr << "--editors needs at least one editor" << std::endl;
+            return 1;
+        }
+        
+        std::cout << numEditors << " editors" << std::endl << std::endl;
+        for (auto& result : measureEditors (numEditors))
+        {
+            std::cout << result.name.paddedRight (' ', 52) << String (result.value, 3).paddedLeft (' ', 10)
+                      << getChange (baseline, result.name, result.value) << std::endl;
+            savedLines.add (result.name + "," + String (result.value, 6));
+        }
+        
+        if (saveFile != File())
+            saveFile.replaceWithText (savedLines.joinIntoString ("\n") + "\n");
+        
+        return 0;
+    }
+    
+    std::cout << SystemStats::getCpuModel() << ", " << SystemStats::getCpuSpeedInMegahertz() << " MHz, "
+              << secondsOfAudio << " s of audio per run at " << sampleRate << " Hz" << std::endl << std::endl;
+    std::cout << String ("run").paddedRight (' ', 52) << String ("ns/frame").paddedLeft (' ', 10)
+              << String ("cycles/frame").paddedLeft (' ', 14) << String ("x realtime").paddedLeft (' ', 12)
+              << (baseline.size() > 0 ? String ("change").paddedLeft (' ', 10) : String()) << std::endl;
+    
+    for (int doublePrecision = 0; doublePrecision < 2; ++doublePrecision)
+    {
+        if (precision.isNotEmpty() && (precision == "double") != (doublePrecision != 0))
+            continue;
+        
+        for (int automated = 0; automated < 2; ++automated)
+        {
+            for (int numInputChannels = 2; numInputChannels <= 4; numInputChannels += 2)
+            {
+                for (int stereoMode = pseudoMsIdx; stereoMode <= blumleinIdx; ++stereoMode)
+                {
+                    for (auto blockSize : blockSizes)
+                    {
+                        const BenchmarkResult result = doublePrecision != 0 ? runBenchmark<double> (stereoMode, numInputChannels, blockSize, automated != 0, secondsOfAudio)
+                                                                            : runBenchmark<float> (stereoMode, numInputChannels, blockSize, automated != 0, secondsOfAudio);
+                        
+                        String line = result.name.paddedRight (' ', 52)
+                                      + String (result.nsPerFrame, 3).paddedLeft (' ', 10)
+                                      + String (result.cyclesPerFrame, 2).paddedLeft (' ', 14)
+                                      + String (roundToInt (result.realtimeFactor)).paddedLeft (' ', 12);
+                        
+                        std::cout << line + getChange (baseline, result.name, result.nsPerFrame) << std::endl;
+                        savedLines.add (result.name + "," + String (result.nsPerFrame, 6));
+                    }
+                }
+            }
+        }
+    }
+    
+    if (saveFile != File())
+        saveFile.replaceWithText (savedLines.joinIntoString ("\n") + "\n");
+    
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ ==============================================================================
+ AllocationCheck.h
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Best-effort check for allocations on the audio thread, in debug builds only. The processor only marks
+// the scope of processBlock in a thread-local flag. Replacing the global operator new to test that flag
+// would swap the allocator of the whole host process, so only the benchmark does that, in its own binary.
+// Such a hook sees containers, Strings and std::function growing, but not malloc, HeapBlock or other
+// allocators that bypass operator new.
+#ifndef STEREOCREATOR_CHECK_ALLOCATIONS
+ #define STEREOCREATOR_CHECK_ALLOCATIONS JUCE_DEBUG
+#endif
+
+namespace AllocationCheck
+{
+    // set while the audio thread is inside processBlock
+    inline bool& isForbidden()
+    {
+        thread_local bool forbidden = false;
+        return forbidden;
+    }
+
+    // marks its lifetime as a scope that mustn't allocate
+    struct ScopedCheck
+    {
+        ScopedCheck()  { isForbidden() = true; }
+        ~ScopedCheck() { isForbidden() = false; }
+    };
+
+    // lifts the check for code that is allowed to allocate
+    struct ScopedSuspender
+    {
+        ScopedSuspender()  : wasForbidden (isForbidden()) { isForbidden() = false; }
+        ~ScopedSuspender() { isForbidden() = wasForbidden; }
+        const bool wasForbidden;
+    };
+}
+
+#if STEREOCREATOR_CHECK_ALLOCATIONS
+ #define FORBID_ALLOCATION_IN_SCOPE  const AllocationCheck::ScopedCheck allocationCheck;
+ #define ALLOW_ALLOCATION_IN_SCOPE   const AllocationCheck::ScopedSuspender allowAllocation;
+#else
+ #define FORBID_ALLOCATION_IN_SCOPE
+ #define ALLOW_ALLOCATION_IN_SCOPE
+#endif
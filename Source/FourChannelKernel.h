@@ -0,0 +1,123 @@
+/*
+ ==============================================================================
+ FourChannelKernel.h
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+// Only included by the kernel translation units, after their instruction set has been selected.
+// Everything in here is static so that no instantiation is shared between translation units
+// compiled for different instruction sets.
+
+#pragma once
+
+#include "MixingKernels.h"
+
+// Ops provides the vector type, its width and load/store/arithmetic for one instruction set.
+// The coefficients are computed in the same order as in the scalar kernel of the processor,
+// so both produce the same output.
+template <typename Ops>
+static void mixFourChannels (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels)
+{
+    typedef typename Ops::Vector Vector;
+
+    // every coefficient and level is a named register, so no compiler has to unroll loops over the
+    // channels to keep them out of memory
+    const Vector startLeftL = Ops::expand (ramp.start.gains[0][0]), incrementLeftL = Ops::expand (ramp.increment.gains[0][0]);
+    const Vector startLeftR = Ops::expand (ramp.start.gains[0][1]), incrementLeftR = Ops::expand (ramp.increment.gains[0][1]);
+    const Vector startLeftF = Ops::expand (ramp.start.gains[0][2]), incrementLeftF = Ops::expand (ramp.increment.gains[0][2]);
+    const Vector startLeftB = Ops::expand (ramp.start.gains[0][3]), incrementLeftB = Ops::expand (ramp.increment.gains[0][3]);
+    const Vector startRightL = Ops::expand (ramp.start.gains[1][0]), incrementRightL = Ops::expand (ramp.increment.gains[1][0]);
+    const Vector startRightR = Ops::expand (ramp.start.gains[1][1]), incrementRightR = Ops::expand (ramp.increment.gains[1][1]);
+    const Vector startRightF = Ops::expand (ramp.start.gains[1][2]), incrementRightF = Ops::expand (ramp.increment.gains[1][2]);
+    const Vector startRightB = Ops::expand (ramp.start.gains[1][3]), incrementRightB = Ops::expand (ramp.increment.gains[1][3]);
+    const Vector startGain = Ops::expand (ramp.startGain);
+    const Vector gainIncrement = Ops::expand (ramp.gainIncrement);
+    const Vector laneOffsets = Ops::laneOffsets();
+    const Vector zero = Ops::expand (0.0f);
+
+    Vector squaresL = zero, squaresR = zero, squaresF = zero, squaresB = zero, squaresLeft = zero, squaresRight = zero;
+    Vector peakL = zero, peakR = zero, peakF = zero, peakB = zero, peakLeft = zero, peakRight = zero;
+
+    float* const left = channels[0];
+    float* const right = channels[1];
+    float* const front = channels[2];
+    float* const back = channels[3];
+
+    for (int i = 0; i < numFrames; i += Ops::width)
+    {
+        const Vector position = Ops::add (Ops::expand ((float) (ramp.position + i)), laneOffsets);
+
+        const Vector l = Ops::load (left + i);
+        const Vector r = Ops::load (right + i);
+        const Vector f = Ops::load (front + i);
+        const Vector b = Ops::load (back + i);
+
+        Vector sum = Ops::mul (Ops::add (startLeftL, Ops::mul (incrementLeftL, position)), l);
+        sum = Ops::add (sum, Ops::mul (Ops::add (startLeftR, Ops::mul (incrementLeftR, position)), r));
+        sum = Ops::add (sum, Ops::mul (Ops::add (startLeftF, Ops::mul (incrementLeftF, position)), f));
+        sum = Ops::add (sum, Ops::mul (Ops::add (startLeftB, Ops::mul (incrementLeftB, position)), b));
+        const Vector gain = Ops::add (startGain, Ops::mul (gainIncrement, position));
+        const Vector outLeft = Ops::mul (gain, sum);
+
+        sum = Ops::mul (Ops::add (startRightL, Ops::mul (incrementRightL, position)), l);
+        sum = Ops::add (sum, Ops::mul (Ops::add (startRightR, Ops::mul (incrementRightR, position)), r));
+        sum = Ops::add (sum, Ops::mul (Ops::add (startRightF, Ops::mul (incrementRightF, position)), f));
+        sum = Ops::add (sum, Ops::mul (Ops::add (startRightB, Ops::mul (incrementRightB, position)), b));
+        const Vector outRight = Ops::mul (gain, sum);
+
+        Ops::store (left + i, outLeft);
+        Ops::store (right + i, outRight);
+        Ops::store (front + i, zero);
+        Ops::store (back + i, zero);
+
+        squaresL = Ops::add (squaresL, Ops::mul (l, l));
+        squaresR = Ops::add (squaresR, Ops::mul (r, r));
+        squaresF = Ops::add (squaresF, Ops::mul (f, f));
+        squaresB = Ops::add (squaresB, Ops::mul (b, b));
+        squaresLeft = Ops::add (squaresLeft, Ops::mul (outLeft, outLeft));
+        squaresRight = Ops::add (squaresRight, Ops::mul (outRight, outRight));
+        peakL = Ops::max (peakL, Ops::abs (l));
+        peakR = Ops::max (peakR, Ops::abs (r));
+        peakF = Ops::max (peakF, Ops::abs (f));
+        peakB = Ops::max (peakB, Ops::abs (b));
+        peakLeft = Ops::max (peakLeft, Ops::abs (outLeft));
+        peakRight = Ops::max (peakRight, Ops::abs (outRight));
+    }
+
+    const Vector inSquares[4] = { squaresL, squaresR, squaresF, squaresB };
+    const Vector inPeaks[4] = { peakL, peakR, peakF, peakB };
+    const Vector outSquares[2] = { squaresLeft, squaresRight };
+    const Vector outPeaks[2] = { peakLeft, peakRight };
+
+    for (int in = 0; in < 4; ++in)
+    {
+        levels.inputSumOfSquares[in] += Ops::sum (inSquares[in]);
+        const float peak = Ops::maxElement (inPeaks[in]);
+        if (peak > levels.inputPeak[in])
+            levels.inputPeak[in] = peak;
+    }
+    for (int out = 0; out < 2; ++out)
+    {
+        levels.outputSumOfSquares[out] += Ops::sum (outSquares[out]);
+        const float peak = Ops::maxElement (outPeaks[out]);
+        if (peak > levels.outputPeak[out])
+            levels.outputPeak[out] = peak;
+    }
+}
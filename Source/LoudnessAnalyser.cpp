@@ -0,0 +1,346 @@
+/*
+ ==============================================================================
+ LoudnessAnalyser.cpp
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include "LoudnessAnalyser.h"
+
+namespace
+{
+    const double subBlockTime = 0.1;
+    const double absoluteGate = -70.0;
+    const double relativeGate = -10.0;
+
+    void clear (InputCovariance& covariance)
+    {
+        for (int row = 0; row < 4; ++row)
+            for (int column = 0; column < 4; ++column)
+                covariance.values[row][column] = 0.0;
+    }
+}
+
+//==============================================================================
+// reads the FIFOs of all prepared analysers every 20 ms while one of them is active. Otherwise it only
+// polls their flags every 100 ms, as the audio thread can't wake it without locking, and it sleeps while
+// no analyser is prepared
+class LoudnessAnalyser::AnalysisThread  : public Thread
+{
+public:
+    AnalysisThread()
+        : Thread ("StereoCreator Loudness")
+    {
+        startThread();
+    }
+
+    ~AnalysisThread() override
+    {
+        stopThread (1000);
+    }
+
+    void add (LoudnessAnalyser* analyser)
+    {
+        {
+            const ScopedLock lock (analysersLock);
+            analysers.addIfNotAlreadyThere (analyser);
+        }
+
+        notify();
+    }
+
+    void remove (LoudnessAnalyser* analyser)
+    {
+        const ScopedLock lock (analysersLock);
+        analysers.removeFirstMatchingValue (analyser);
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            bool isAnyPrepared, isAnyActive = false;
+
+            {
+                const ScopedLock lock (analysersLock);
+                isAnyPrepared = ! analysers.isEmpty();
+                for (auto* analyser : analysers)
+                    isAnyActive = analyser->analysePendingSamples() || isAnyActive;
+            }
+
+            wait (isAnyActive ? 20 : (isAnyPrepared ? 100 : -1));
+        }
+    }
+
+    CriticalSection analysersLock;
+    Array<LoudnessAnalyser*> analysers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisThread)
+};
+
+//==============================================================================
+LoudnessAnalyser::LoudnessAnalyser()
+{
+    clear (subBlockCovariance);
+    clear (gatedCovariance);
+}
+
+LoudnessAnalyser::~LoudnessAnalyser()
+{
+    analysisThread->remove (this);
+}
+
+void LoudnessAnalyser::prepare (double sampleRate, int numChannels, double measurementTime)
+{
+    analysisThread->remove (this);
+
+    currentSampleRate = sampleRate;
+    numInputChannels = jlimit (1, 4, numChannels);
+
+    // one second of headroom for the thread to catch up
+    const int fifoSize = roundToInt (sampleRate) + 1;
+    fifo.setTotalSize (fifoSize);
+    fifo.reset();
+    fifoBuffer.setSize (4, fifoSize);
+
+    // the two stages of the K-weighting filter, calculated for the sample rate
+    {
+        const double frequency = 1681.974450955533;
+        const double gainInDecibels = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan (MathConstants<double>::pi * frequency / sampleRate);
+        const double vh = std::pow (10.0, gainInDecibels / 20.0);
+        const double vb = std::pow (vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        shelf = { (vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                  2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+    }
+    {
+        const double frequency = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan (MathConstants<double>::pi * frequency / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        highPass = { 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+    }
+
+    subBlockLength = jmax (1, roundToInt (subBlockTime * sampleRate));
+
+    // every 100 ms step starts a block, the blocks lying completely within the measurement time are kept
+    blocks.resize ((size_t) jmax (1, roundToInt (measurementTime / subBlockTime) - subBlocksPerBlock + 1));
+
+    isActive = false;
+    isResetPending = false;
+    resetMeasurement();
+
+    analysisThread->add (this);
+}
+
+void LoudnessAnalyser::release()
+{
+    analysisThread->remove (this);
+    isActive = false;
+}
+
+void LoudnessAnalyser::setActive (bool shouldBeActive)
+{
+    if (shouldBeActive == isActive.load())
+        return;
+
+    // the analysis thread resets the measurement before it reads the samples pushed from now on
+    if (shouldBeActive)
+        isResetPending = true;
+
+    isActive = shouldBeActive;
+}
+
+bool LoudnessAnalyser::getGatedCovariance (InputCovariance& covariance) const
+{
+    if (isResetPending.load())
+        return false;
+
+    const SpinLock::ScopedTryLockType lock (resultLock);
+
+    if (! lock.isLocked() || ! isMeasurementComplete)
+        return false;
+
+    covariance = gatedCovariance;
+    return true;
+}
+
+//==============================================================================
+bool LoudnessAnalyser::analysePendingSamples()
+{
+    if (isResetPending.load())
+    {
+        // samples left from before the analyser was deactivated don't belong to the new measurement
+        fifo.finishedRead (fifo.getNumReady());
+        resetMeasurement();
+        isResetPending = false;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+    if (size1 > 0)
+        analyseSamples (start1, size1);
+    if (size2 > 0)
+        analyseSamples (start2, size2);
+
+    fifo.finishedRead (size1 + size2);
+
+    return isActive.load() || fifo.getNumReady() > 0;
+}
+
+void LoudnessAnalyser::resetMeasurement()
+{
+    for (int ch = 0; ch < 4; ++ch)
+        for (int stage = 0; stage < 2; ++stage)
+            filterState[ch][stage][0] = filterState[ch][stage][1] = 0.0;
+
+    subBlockPosition = 0;
+    clear (subBlockCovariance);
+    numSubBlocks = 0;
+
+    nextBlock = 0;
+    numBlocks = 0;
+
+    const SpinLock::ScopedLockType lock (resultLock);
+    clear (gatedCovariance);
+    isMeasurementComplete = false;
+}
+
+void LoudnessAnalyser::analyseSamples (int startSample, int numSamples)
+{
+    const float* channels[4];
+    for (int ch = 0; ch < numInputChannels; ++ch)
+        channels[ch] = fifoBuffer.getReadPointer (ch, startSample);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        double weighted[4];
+
+        for (int ch = 0; ch < numInputChannels; ++ch)
+        {
+            // transposed direct form II, shelf followed by high pass
+            double* state = filterState[ch][0];
+            const double input = channels[ch][i];
+            const double shelved = shelf.b0 * input + state[0];
+            state[0] = shelf.b1 * input - shelf.a1 * shelved + state[1];
+            state[1] = shelf.b2 * input - shelf.a2 * shelved;
+
+            state = filterState[ch][1];
+            const double output = highPass.b0 * shelved + state[0];
+            state[0] = highPass.b1 * shelved - highPass.a1 * output + state[1];
+            state[1] = highPass.b2 * shelved - highPass.a2 * output;
+
+            weighted[ch] = output;
+        }
+
+        for (int row = 0; row < numInputChannels; ++row)
+            for (int column = row; column < numInputChannels; ++column)
+                subBlockCovariance.values[row][column] += weighted[row] * weighted[column];
+
+        if (++subBlockPosition == subBlockLength)
+            finishSubBlock();
+    }
+}
+
+void LoudnessAnalyser::finishSubBlock()
+{
+    for (int row = 0; row < 4; ++row)
+        for (int column = 0; column < row; ++column)
+            subBlockCovariance.values[row][column] = subBlockCovariance.values[column][row];
+
+    recentSubBlocks[numSubBlocks % subBlocksPerBlock] = subBlockCovariance;
+    ++numSubBlocks;
+
+    clear (subBlockCovariance);
+    subBlockPosition = 0;
+
+    if (numSubBlocks < subBlocksPerBlock)
+        return;
+
+    InputCovariance& block = blocks[(size_t) nextBlock];
+    clear (block);
+    for (int subBlock = 0; subBlock < subBlocksPerBlock; ++subBlock)
+        addTo (block, recentSubBlocks[subBlock]);
+
+    nextBlock = (nextBlock + 1) % (int) blocks.size();
+    numBlocks = jmin (numBlocks + 1, (int) blocks.size());
+
+    publishGatedCovariance();
+}
+
+void LoudnessAnalyser::publishGatedCovariance()
+{
+    // the gates use the loudness of the left/right inputs
+    const double blockLength = subBlocksPerBlock * subBlockLength;
+    const auto getMeanSquare = [blockLength] (const InputCovariance& covariance)
+    {
+        return (covariance.values[0][0] + covariance.values[1][1]) / blockLength;
+    };
+    const auto getLoudness = [] (double meanSquare)
+    {
+        return -0.691 + 10.0 * std::log10 (meanSquare + 1.0e-20);
+    };
+
+    double sumOfMeanSquares = 0.0;
+    int numAboveAbsoluteGate = 0;
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        const double meanSquare = getMeanSquare (blocks[(size_t) i]);
+        if (getLoudness (meanSquare) > absoluteGate)
+        {
+            sumOfMeanSquares += meanSquare;
+            ++numAboveAbsoluteGate;
+        }
+    }
+
+    InputCovariance gated;
+    clear (gated);
+    int numGated = 0;
+
+    if (numAboveAbsoluteGate > 0)
+    {
+        const double gate = jmax (absoluteGate, getLoudness (sumOfMeanSquares / numAboveAbsoluteGate) + relativeGate);
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            if (getLoudness (getMeanSquare (blocks[(size_t) i])) > gate)
+            {
+                addTo (gated, blocks[(size_t) i]);
+                ++numGated;
+            }
+        }
+    }
+
+    const SpinLock::ScopedLockType lock (resultLock);
+    gatedCovariance = gated;
+    isMeasurementComplete = numBlocks == (int) blocks.size() && numGated > 0;
+}
+
+void LoudnessAnalyser::addTo (InputCovariance& destination, const InputCovariance& source)
+{
+    for (int row = 0; row < 4; ++row)
+        for (int column = 0; column < 4; ++column)
+            destination.values[row][column] += source.values[row][column];
+}
@@ -0,0 +1,138 @@
+/*
+ ==============================================================================
+ LoudnessAnalyser.h
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// covariance of the left/right/front/back inputs
+struct InputCovariance
+{
+    double values[4][4];
+};
+
+//==============================================================================
+/**
+ Measures the K-weighted input covariance with the gating of ITU-R BS.1770 on a background thread.
+
+ The K-weighting filter is the same for every channel, so the K-weighted power of any mix of the
+ inputs follows from this covariance and the mixing matrix. The gates work on 400 ms blocks with
+ 75 % overlap, using the loudness of the left/right inputs, over the last measurementTime seconds.
+
+ The analyser only works while it is active. The audio thread then copies its input into a lock-free
+ FIFO, which one thread shared by all analysers of the process reads. The audio thread only sets
+ atomic flags, which that thread polls at a lower rate while no analyser is active.
+*/
+class LoudnessAnalyser
+{
+public:
+    LoudnessAnalyser();
+    ~LoudnessAnalyser();
+
+    // allocates for the new settings, not on the audio thread. The analyser is inactive afterwards
+    void prepare (double sampleRate, int numChannels, double measurementTime);
+    void release();
+
+    // audio thread. Activating starts a new measurement, the result of an earlier one is discarded
+    void setActive (bool shouldBeActive);
+
+    // audio thread while active, samples that don't fit into the FIFO are dropped
+    template <typename FloatType>
+    void pushSamples (const AudioBuffer<FloatType>& buffer, int numSamples);
+
+    // audio thread, returns false if the measurement doesn't cover measurementTime yet, or if the
+    // analyser is just publishing a new result
+    bool getGatedCovariance (InputCovariance& covariance) const;
+
+private:
+    class AnalysisThread;
+
+    // called by the analysis thread, returns false once the analyser is inactive and the FIFO is empty
+    bool analysePendingSamples();
+    void resetMeasurement();
+    void analyseSamples (int startSample, int numSamples);
+    void finishSubBlock();
+    void publishGatedCovariance();
+
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+
+    static void addTo (InputCovariance& destination, const InputCovariance& source);
+
+    // 400 ms gating blocks are made of four 100 ms sub-blocks
+    static constexpr int subBlocksPerBlock = 4;
+
+    double currentSampleRate = 48000.0;
+    int numInputChannels = 2;
+
+    AbstractFifo fifo { 1 };
+    AudioBuffer<float> fifoBuffer;
+
+    Biquad shelf, highPass;
+    double filterState[4][2][2];
+
+    int subBlockLength = 4800;
+    int subBlockPosition = 0;
+    InputCovariance subBlockCovariance;
+    InputCovariance recentSubBlocks[subBlocksPerBlock];
+    int numSubBlocks = 0;
+
+    // covariances of the gating blocks within the measurement time, as a ring
+    std::vector<InputCovariance> blocks;
+    int nextBlock = 0;
+    int numBlocks = 0;
+
+    SpinLock resultLock;
+    InputCovariance gatedCovariance;
+    bool isMeasurementComplete = false;
+
+    // written by the audio thread
+    std::atomic<bool> isActive { false };
+    std::atomic<bool> isResetPending { false };
+
+    SharedResourcePointer<AnalysisThread> analysisThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoudnessAnalyser)
+};
+
+template <typename FloatType>
+void LoudnessAnalyser::pushSamples (const AudioBuffer<FloatType>& buffer, int numSamples)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    for (int ch = 0; ch < numInputChannels; ++ch)
+    {
+        const FloatType* source = buffer.getReadPointer (ch);
+        float* destination = fifoBuffer.getWritePointer (ch);
+
+        for (int i = 0; i < size1; ++i)
+            destination[start1 + i] = (float) source[i];
+        for (int i = 0; i < size2; ++i)
+            destination[start2 + i] = (float) source[size1 + i];
+    }
+
+    fifo.finishedWrite (size1 + size2);
+}
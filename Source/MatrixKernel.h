@@ -0,0 +1,69 @@
+/*
+ ==============================================================================
+ MatrixKernel.h
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+// Only included by the kernel translation units, like FourChannelKernel.h.
+
+#pragma once
+
+#include "MixingKernels.h"
+
+// Every input register is loaded once per iteration and used for all outputs. The coefficients are
+// computed in the same order as in the scalar loop of the processor, so both produce the same output.
+template <typename Ops>
+static void mixMatrix (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp)
+{
+    typedef typename Ops::Vector Vector;
+    const int maxInputs = VirtualMicMatrix::maxInputs;
+    const int maxOutputs = VirtualMicMatrix::maxOutputs;
+
+    Vector start[maxOutputs][maxInputs];
+    Vector increment[maxOutputs][maxInputs];
+    for (int out = 0; out < numOutputs; ++out)
+    {
+        for (int in = 0; in < numInputs; ++in)
+        {
+            start[out][in] = Ops::expand (ramp.start.gains[out][in]);
+            increment[out][in] = Ops::expand (ramp.increment.gains[out][in]);
+        }
+    }
+    const Vector laneOffsets = Ops::laneOffsets();
+    const Vector zero = Ops::expand (0.0f);
+
+    for (int i = 0; i < numFrames; i += Ops::width)
+    {
+        const Vector position = Ops::add (Ops::expand ((float) (ramp.position + i)), laneOffsets);
+
+        Vector input[maxInputs];
+        for (int in = 0; in < numInputs; ++in)
+            input[in] = Ops::load (inputs[in] + i);
+
+        for (int out = 0; out < numOutputs; ++out)
+        {
+            Vector sum = zero;
+            for (int in = 0; in < numInputs; ++in)
+                sum = Ops::add (sum, Ops::mul (Ops::add (start[out][in], Ops::mul (increment[out][in], position)), input[in]));
+
+            Ops::store (outputs[out] + i, sum);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ ==============================================================================
+ MixingKernels.cpp
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include "MixingKernels.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON || defined (__ARM_NEON) || defined (__ARM_NEON__)
+ #include <arm_neon.h>
+ #define STEREOCREATOR_NEON_KERNEL 1
+#endif
+
+#include "FourChannelKernel.h"
+#include "MatrixKernel.h"
+
+namespace
+{
+   #if JUCE_INTEL
+    // four frames per register, SSE2 is available on every CPU the plug-in runs on
+    struct SseOps
+    {
+        typedef __m128 Vector;
+        static const int width = 4;
+
+        static forcedinline Vector load (const float* source)               { return _mm_loadu_ps (source); }
+        static forcedinline void store (float* destination, Vector value)   { _mm_storeu_ps (destination, value); }
+        static forcedinline Vector expand (float value)                     { return _mm_set1_ps (value); }
+        static forcedinline Vector laneOffsets()                            { return _mm_setr_ps (0.0f, 1.0f, 2.0f, 3.0f); }
+        static forcedinline Vector add (Vector a, Vector b)                 { return _mm_add_ps (a, b); }
+        static forcedinline Vector mul (Vector a, Vector b)                 { return _mm_mul_ps (a, b); }
+        static forcedinline Vector max (Vector a, Vector b)                 { return _mm_max_ps (a, b); }
+        static forcedinline Vector abs (Vector a)                           { return _mm_andnot_ps (_mm_set1_ps (-0.0f), a); }
+
+        static forcedinline float sum (Vector a)
+        {
+            float values[width];
+            _mm_storeu_ps (values, a);
+            return values[0] + values[1] + values[2] + values[3];
+        }
+
+        static forcedinline float maxElement (Vector a)
+        {
+            float values[width];
+            _mm_storeu_ps (values, a);
+            return jmax (values[0], values[1], values[2], values[3]);
+        }
+    };
+   #elif STEREOCREATOR_NEON_KERNEL
+    // four frames per register
+    struct NeonOps
+    {
+        typedef float32x4_t Vector;
+        static const int width = 4;
+
+        static forcedinline Vector load (const float* source)               { return vld1q_f32 (source); }
+        static forcedinline void store (float* destination, Vector value)   { vst1q_f32 (destination, value); }
+        static forcedinline Vector expand (float value)                     { return vdupq_n_f32 (value); }
+        static forcedinline Vector add (Vector a, Vector b)                 { return vaddq_f32 (a, b); }
+        static forcedinline Vector mul (Vector a, Vector b)                 { return vmulq_f32 (a, b); }
+        static forcedinline Vector max (Vector a, Vector b)                 { return vmaxq_f32 (a, b); }
+        static forcedinline Vector abs (Vector a)                           { return vabsq_f32 (a); }
+
+        static forcedinline Vector laneOffsets()
+        {
+            const float offsets[width] = { 0.0f, 1.0f, 2.0f, 3.0f };
+            return vld1q_f32 (offsets);
+        }
+
+        static forcedinline float sum (Vector a)
+        {
+            return vgetq_lane_f32 (a, 0) + vgetq_lane_f32 (a, 1) + vgetq_lane_f32 (a, 2) + vgetq_lane_f32 (a, 3);
+        }
+
+        static forcedinline float maxElement (Vector a)
+        {
+            return jmax (vgetq_lane_f32 (a, 0), vgetq_lane_f32 (a, 1), vgetq_lane_f32 (a, 2), vgetq_lane_f32 (a, 3));
+        }
+    };
+   #endif
+}
+
+#if JUCE_INTEL
+void MixingKernels::mixFourChannelsSse (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels)
+{
+    mixFourChannels<SseOps> (channels, numFrames, ramp, levels);
+}
+
+void MixingKernels::mixMatrixSse (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp)
+{
+    mixMatrix<SseOps> (inputs, numInputs, outputs, numOutputs, numFrames, ramp);
+}
+#elif STEREOCREATOR_NEON_KERNEL
+void MixingKernels::mixFourChannelsNeon (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels)
+{
+    mixFourChannels<NeonOps> (channels, numFrames, ramp, levels);
+}
+
+void MixingKernels::mixMatrixNeon (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp)
+{
+    mixMatrix<NeonOps> (inputs, numInputs, outputs, numOutputs, numFrames, ramp);
+}
+#endif
+
+MixingKernels::FourChannelKernel MixingKernels::getFourChannelKernel()
+{
+   #if JUCE_INTEL
+    if (SystemStats::hasAVX())
+        return mixFourChannelsAvx;
+    
+    if (SystemStats::hasSSE2())
+        return mixFourChannelsSse;
+   #elif STEREOCREATOR_NEON_KERNEL
+    return mixFourChannelsNeon;
+   #endif
+    
+    return nullptr;
+}
+
+MixingKernels::MatrixKernel MixingKernels::getMatrixKernel()
+{
+   #if JUCE_INTEL
+    if (SystemStats::hasAVX())
+        return mixMatrixAvx;
+    
+    if (SystemStats::hasSSE2())
+        return mixMatrixSse;
+   #elif STEREOCREATOR_NEON_KERNEL
+    return mixMatrixNeon;
+   #endif
+    
+    return nullptr;
+}
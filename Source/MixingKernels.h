@@ -0,0 +1,106 @@
+/*
+ ==============================================================================
+ MixingKernels.h
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// gains from the left/right/front/back inputs to the left/right outputs
+struct MixingMatrix
+{
+    void setRow (int outputChannel, float left, float right, float front = 0.0f, float back = 0.0f)
+    {
+        gains[outputChannel][0] = left;
+        gains[outputChannel][1] = right;
+        gains[outputChannel][2] = front;
+        gains[outputChannel][3] = back;
+    }
+
+    float gains[2][4];
+};
+
+// matrix and overall gain ramped through a block, the values at sample n of the block are
+// start + increment * n, so every kernel computes the same coefficients
+struct MixingRamp
+{
+    MixingMatrix start;
+    MixingMatrix increment;
+    float startGain;
+    float gainIncrement;
+    int position; // index of the next sample within the block
+};
+
+// sums of squares and peaks of one block, accumulated by the mixing kernel
+struct BlockLevels
+{
+    float inputSumOfSquares[4];
+    float inputPeak[4];
+    float outputSumOfSquares[2];
+    float outputPeak[2];
+};
+
+// gains from up to four OC-818 capsule pairs to up to eight virtual microphones
+struct VirtualMicMatrix
+{
+    static const int maxInputs = 8;
+    static const int maxOutputs = 8;
+
+    float gains[maxOutputs][maxInputs];
+};
+
+// virtual microphone matrix ramped through a tile like MixingRamp, without a separate gain
+struct VirtualMicRamp
+{
+    VirtualMicMatrix start;
+    VirtualMicMatrix increment;
+    int position;
+};
+
+namespace MixingKernels
+{
+    // the vectorised kernels take multiples of this many frames, the width of the widest register
+    const int framesPerIteration = 8;
+
+    // mixes numFrames (a multiple of framesPerIteration) frames of left/right/front/back in place into
+    // left/right, clears front/back and accumulates the levels, starting at ramp.position
+    typedef void (*FourChannelKernel) (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels);
+
+    // returns the widest kernel the CPU supports, or nullptr if there is none for this architecture
+    FourChannelKernel getFourChannelKernel();
+
+    // mixes numFrames (a multiple of framesPerIteration) frames of every input into every output in one pass.
+    // The outputs must not overlap the inputs
+    typedef void (*MatrixKernel) (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp);
+
+    MatrixKernel getMatrixKernel();
+
+   #if JUCE_INTEL
+    void mixFourChannelsSse (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels);
+    void mixFourChannelsAvx (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels);
+    void mixMatrixSse (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp);
+    void mixMatrixAvx (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp);
+   #elif JUCE_USE_ARM_NEON || defined (__ARM_NEON) || defined (__ARM_NEON__)
+    void mixFourChannelsNeon (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels);
+    void mixMatrixNeon (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp);
+   #endif
+}
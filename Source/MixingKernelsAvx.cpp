@@ -0,0 +1,103 @@
+/*
+ ==============================================================================
+ MixingKernelsAvx.cpp
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+// The AVX kernels are compiled for AVX in this file only, the rest of the plug-in keeps the baseline
+// instruction set. They are only called after getFourChannelKernel()/getMatrixKernel() have checked the CPU.
+
+#include "MixingKernels.h"
+
+#if JUCE_INTEL
+
+#include <immintrin.h>
+
+// JUCE and the standard headers are included above, so only the kernel below is built for AVX
+#if JUCE_CLANG
+ #pragma clang attribute push (__attribute__ ((target ("avx"))), apply_to = function)
+#elif JUCE_GCC
+ #pragma GCC push_options
+ #pragma GCC target ("avx")
+#endif
+
+#include "FourChannelKernel.h"
+#include "MatrixKernel.h"
+
+namespace
+{
+    // eight frames per register
+    struct AvxOps
+    {
+        typedef __m256 Vector;
+        static const int width = 8;
+
+        static inline Vector load (const float* source)                 { return _mm256_loadu_ps (source); }
+        static inline void store (float* destination, Vector value)     { _mm256_storeu_ps (destination, value); }
+        static inline Vector expand (float value)                       { return _mm256_set1_ps (value); }
+        static inline Vector laneOffsets()                              { return _mm256_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+        static inline Vector add (Vector a, Vector b)                   { return _mm256_add_ps (a, b); }
+        static inline Vector mul (Vector a, Vector b)                   { return _mm256_mul_ps (a, b); }
+        static inline Vector max (Vector a, Vector b)                   { return _mm256_max_ps (a, b); }
+        static inline Vector abs (Vector a)                             { return _mm256_andnot_ps (_mm256_set1_ps (-0.0f), a); }
+
+        static inline float sum (Vector a)
+        {
+            float values[width];
+            _mm256_storeu_ps (values, a);
+
+            float result = values[0];
+            for (int i = 1; i < width; ++i)
+                result += values[i];
+
+            return result;
+        }
+
+        static inline float maxElement (Vector a)
+        {
+            float values[width];
+            _mm256_storeu_ps (values, a);
+
+            float result = values[0];
+            for (int i = 1; i < width; ++i)
+                result = values[i] > result ? values[i] : result;
+
+            return result;
+        }
+    };
+}
+
+void MixingKernels::mixFourChannelsAvx (float* const* channels, int numFrames, const MixingRamp& ramp, BlockLevels& levels)
+{
+    mixFourChannels<AvxOps> (channels, numFrames, ramp, levels);
+}
+
+void MixingKernels::mixMatrixAvx (const float* const* inputs, int numInputs, float* const* outputs, int numOutputs, int numFrames, const VirtualMicRamp& ramp)
+{
+    mixMatrix<AvxOps> (inputs, numInputs, outputs, numOutputs, numFrames, ramp);
+}
+
+#if JUCE_CLANG
+ #pragma clang attribute pop
+#elif JUCE_GCC
+ #pragma GCC pop_options
+#endif
+
+#endif
@@ -47,13 +47,6 @@ StereoCreatorAudioProcessorEditor::StereoCreatorAudioProcessorEditor (StereoCrea
     arrayImage4Ch = ImageCache::getFromMemory (arrayPng4Ch, arrayPng4ChSize);
     arrayImage2Ch = ImageCache::getFromMemory (arrayPng2Ch, arrayPng2ChSize);
     
-    bCardPath.loadPathFromData (bCardData, sizeof (bCardData));
-    cardPath.loadPathFromData (cardData, sizeof (cardData));
-    sCardPath.loadPathFromData (sCardData, sizeof (sCardData));
-    hCardPath.loadPathFromData (hCardData, sizeof (hCardData));
-    eightPath.loadPathFromData (eightData, sizeof (eightData));
-    omniPath.loadPathFromData (omniData, sizeof (omniData));
-    
     aaLogoBgPath.loadPathFromData (aaLogoData, sizeof (aaLogoData));
     
     // colours
@@ -122,24 +115,24 @@ StereoCreatorAudioProcessorEditor::StereoCreatorAudioProcessorEditor (StereoCrea
     slPseudoStPattern.setTooltipEditable(true);
     slPseudoStPattern.setColour(Slider::rotarySliderOutlineColourId, colours[2]);
     slPseudoStPattern.addListener(this);
-    slPseudoStPattern.dirStripTop.setPatternPathsAndFactors(bCardPath, cardPath, bCardFact, cardFact);
-    slPseudoStPattern.dirStripBottom.setPatternPathsAndFactors(omniPath, hCardPath, omniFact, hCardFact);
+    slPseudoStPattern.dirStripTop.setPatternPathsAndFactors(patternPaths->bCardPath, patternPaths->cardPath, bCardFact, cardFact);
+    slPseudoStPattern.dirStripBottom.setPatternPathsAndFactors(patternPaths->omniPath, patternPaths->hCardPath, omniFact, hCardFact);
     
     addAndMakeVisible(&slMidPattern);
     slAttMidPattern.reset(new ReverseSlider::SliderAttachment (valueTreeState, "msMidPattern", slMidPattern));
     slMidPattern.setTooltipEditable(true);
     slMidPattern.setColour(Slider::rotarySliderOutlineColourId, colours[2]);
     slMidPattern.addListener(this);
-    slMidPattern.dirStripTop.setPatternPathsAndFactors(bCardPath, cardPath, bCardFact, cardFact);
-    slMidPattern.dirStripBottom.setPatternPathsAndFactors(omniPath, hCardPath, omniFact, hCardFact);
+    slMidPattern.dirStripTop.setPatternPathsAndFactors(patternPaths->bCardPath, patternPaths->cardPath, bCardFact, cardFact);
+    slMidPattern.dirStripBottom.setPatternPathsAndFactors(patternPaths->omniPath, patternPaths->hCardPath, omniFact, hCardFact);
     
     addAndMakeVisible(&slXyPattern);
     slAttXyPattern.reset(new ReverseSlider::SliderAttachment (valueTreeState, "trueStXyPattern", slXyPattern));
     slXyPattern.setTooltipEditable (true);
     slXyPattern.setColour(Slider::rotarySliderOutlineColourId, colours[2]);
     slXyPattern.addListener(this);
-    slXyPattern.dirStripTop.setPatternPathsAndFactors(cardPath, sCardPath, cardFact, sCardFact);
-    slXyPattern.dirStripBottom.setPatternPathsAndFactors(bCardPath, sCardPath, bCardFact, hCardFact);
+    slXyPattern.dirStripTop.setPatternPathsAndFactors(patternPaths->cardPath, patternPaths->sCardPath, cardFact, sCardFact);
+    slXyPattern.dirStripBottom.setPatternPathsAndFactors(patternPaths->bCardPath, patternPaths->sCardPath, bCardFact, hCardFact);
     
     for (int i = 0; i < 5; i++)
     {
@@ -177,8 +170,7 @@ StereoCreatorAudioProcessorEditor::StereoCreatorAudioProcessorEditor (StereoCrea
     addAndMakeVisible(&tbCalcCompGain);
     tbAttCalcCompGain.reset(new ButtonAttachment (valueTreeState, "calcCompGain", tbCalcCompGain));
     tbCalcCompGain.setButtonText("calculate");
-    tbCalcCompGain.addListener(this);
-    tbCalcCompGain.setToggleState(false, NotificationType::dontSendNotification);
+    tbCalcCompGain.setClickingTogglesState(true);
     
     addAndMakeVisible(&tbAbLayer[0]);
     tbAbLayer[0].setButtonText("A");
@@ -270,48 +262,63 @@ StereoCreatorAudioProcessorEditor::StereoCreatorAudioProcessorEditor (StereoCrea
     
     setSliderVisibility(false, false, false, false, false, false, false);
     
-    startTimer(80);
+    updateInputLayout();
+    processor.addChangeListener(this);
+    
+   #if JUCE_VERSION < 0x060100
+    startTimerHz(60);
+   #endif
 }
 
 StereoCreatorAudioProcessorEditor::~StereoCreatorAudioProcessorEditor()
 {
+    processor.removeChangeListener(this);
     setLookAndFeel (nullptr);
 }
 
 //==============================================================================
 void StereoCreatorAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    const int currHeight = getHeight();
-    const int currWidth = getWidth();
+    // the background only changes with the size and the input layout, it is rendered once per size and pixel scale
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (backgroundImage.isNull() || backgroundImageScale != scale)
+        renderBackgroundImage (scale);
+    
+    g.drawImageTransformed (backgroundImage, AffineTransform::scale (1.0f / backgroundImageScale));
+}
+
+void StereoCreatorAudioProcessorEditor::renderBackgroundImage (float scale)
+{
+    backgroundImageScale = scale;
+    backgroundImage = Image (Image::RGB, jmax (1, roundToInt (getWidth() * scale)), jmax (1, roundToInt (getHeight() * scale)), false);
+    
+    Graphics g (backgroundImage);
+    g.addTransform (AffineTransform::scale (scale));
     
     g.fillAll (globalLaF.ClBackground);
     
     if (processor.getNumInpCh() == 2) // two channel input
-    {
-        title.setLineBounds(true, 0, 0, 0); // default line
         g.drawImageWithin(arrayImage2Ch, 0, 0, arrayImage2Ch.getWidth() / 2, arrayImage2Ch.getHeight() / 2, RectanglePlacement::onlyReduceInSize);
-        
-        
-        helpToolTip.setTooltip(helpText2Ch);
-    }
     else // four channel input
-    {
-        title.setLineBounds(false, 0, 33, 101);
         g.drawImageWithin(arrayImage4Ch, 4, 8, arrayImage4Ch.getWidth() / 2, arrayImage4Ch.getHeight() / 2, RectanglePlacement::onlyReduceInSize);
-        helpToolTip.setTooltip(helpText4Ch);
-        
-    }
     
     // background logo
-    aaLogoBgPath.applyTransform (aaLogoBgPath.getTransformToScaleToFit (0.50f * currWidth, 0.25f * currHeight,
-                                                                        0.58f * currWidth, 0.58f * currWidth, true, Justification::centred));
     g.setColour (Colours::white.withAlpha(0.1f));
-    g.strokePath (aaLogoBgPath, PathStrokeType (0.1f));
-    g.fillPath (aaLogoBgPath);
+    g.strokePath (scaledLogoBgPath, PathStrokeType (0.1f));
+    g.fillPath (scaledLogoBgPath);
 }
 
 void StereoCreatorAudioProcessorEditor::resized()
 {
+    const int currHeight = getHeight();
+    const int currWidth = getWidth();
+    
+    // the logo is scaled from the original path, so the transform doesn't accumulate
+    scaledLogoBgPath = aaLogoBgPath;
+    scaledLogoBgPath.applyTransform (aaLogoBgPath.getTransformToScaleToFit (0.50f * currWidth, 0.25f * currHeight,
+                                                                            0.58f * currWidth, 0.58f * currWidth, true, Justification::centred));
+    backgroundImage = Image();
+    
     const int leftRightMargin = 30;
     const int headerHeight = 60;
     const int footerHeight = 15;
@@ -530,7 +537,6 @@ void StereoCreatorAudioProcessorEditor::comboBoxChanged(ComboBox *cb)
                 break;
         }
     }
-    repaint();
 }
 
 void StereoCreatorAudioProcessorEditor::sliderValueChanged(Slider *slider)
@@ -575,7 +581,6 @@ void StereoCreatorAudioProcessorEditor::sliderValueChanged(Slider *slider)
         dirVis[0].setPatternRotation(slRotation.getValue() - 45.0f);
         dirVis[1].setPatternRotation(slRotation.getValue() + 45.0f);
     }
-    repaint();
 }
 
 void StereoCreatorAudioProcessorEditor::buttonClicked(Button *button)
@@ -600,11 +605,6 @@ void StereoCreatorAudioProcessorEditor::buttonClicked(Button *button)
         }
         comboBoxChanged(&cbStereoMode);
     }
-    else if (button == &tbCalcCompGain)
-    {
-        bool isToggled = button->getToggleState();
-        button->setToggleState(!isToggled, NotificationType::dontSendNotification);
-    }
 }
 
 void StereoCreatorAudioProcessorEditor::setAbButtonAlphaFromLayerState(int layerState)
@@ -627,36 +627,49 @@ void StereoCreatorAudioProcessorEditor::setDirVisAlphaFromSliderValues(Slider *s
     float newAlpha = (slider->getValue() + std::abs(slider->getMinimum())) / sliderRange * 0.75f;
     newAlpha += 0.25f;
     dirVis[dirVisIdx].setPatternAlpha(newAlpha);
-    repaint();
 }
 
-void StereoCreatorAudioProcessorEditor::timerCallback()
+void StereoCreatorAudioProcessorEditor::changeListenerCallback(ChangeBroadcaster* source)
+{
+    updateInputLayout();
+}
+
+void StereoCreatorAudioProcessorEditor::updateInputLayout()
 {
-    for (int i = 0; i < 4; ++i)
-    {
-        inputMeter[i].setLevel(processor.inRms[i].get());
-    }
-    outputMeter[0].setLevel(processor.outRms[0].get());
-    outputMeter[1].setLevel(processor.outRms[1].get());
-    
     if (processor.getNumInpCh() == 2) // two channel input
     {
+        title.setLineBounds(true, 0, 0, 0); // default line
+        helpToolTip.setTooltip(helpText2Ch);
         setComboBoxItemsEnabled(true);
-        inputMeter[0].setVisible(true);
-        inputMeter[1].setVisible(true);
         inputMeter[2].setVisible(false);
         inputMeter[3].setVisible(false);
     }
     else // four channel input
     {
+        title.setLineBounds(false, 0, 33, 101);
+        helpToolTip.setTooltip(helpText4Ch);
         setComboBoxItemsEnabled(false);
-        inputMeter[0].setVisible(true);
-        inputMeter[1].setVisible(true);
         inputMeter[2].setVisible(true);
         inputMeter[3].setVisible(true);
     }
     
-    tbCalcCompGain.setToggleState(processor.compensationGainCalcOver(), NotificationType::dontSendNotification);
+    // the array image in the background depends on the number of inputs
+    backgroundImage = Image();
+    repaint();
+}
+
+void StereoCreatorAudioProcessorEditor::updateMeters()
+{
+    for (int i = 0; i < 4; ++i)
+        inputMeter[i].setLevels(processor.inRms[i].get(), processor.inPeak[i].get());
+    
+    outputMeter[0].setLevels(processor.outRms[0].get(), processor.outPeak[0].get());
+    outputMeter[1].setLevels(processor.outRms[1].get(), processor.outPeak[1].get());
+}
+
+void StereoCreatorAudioProcessorEditor::timerCallback()
+{
+    updateMeters();
 }
 
 void StereoCreatorAudioProcessorEditor::setComboBoxItemsEnabled(bool twoChannelInput)
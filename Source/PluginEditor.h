@@ -41,7 +41,7 @@ typedef AudioProcessorValueTreeState::ComboBoxAttachment ComboBoxAttachment;
 //==============================================================================
 /**
 */
-class StereoCreatorAudioProcessorEditor  : public juce::AudioProcessorEditor, private ComboBox::Listener, private Slider::Listener, private Button::Listener, private Timer
+class StereoCreatorAudioProcessorEditor  : public juce::AudioProcessorEditor, private ComboBox::Listener, private Slider::Listener, private Button::Listener, private ChangeListener, private Timer
 {
 public:
     StereoCreatorAudioProcessorEditor (StereoCreatorAudioProcessor&, AudioProcessorValueTreeState&);
@@ -56,6 +56,7 @@ public:
     void buttonClicked (Button* button) override;
     
     void setComboBoxItemsEnabled(bool twoChannelInput);
+    void updateInputLayout();
     void setSliderVisibility(bool msTwoCh, bool msFourCh, bool width, bool pattern, bool rotation, bool xyPattern, bool xyAngle);
     
     int getControlParameterIndex (Component& control) override;
@@ -100,13 +101,18 @@ private:
     FirstOrderDirectivityVisualizer dirVis[2];
     Colour colours[3];
     
-    Path aaLogoBgPath;
+    Path aaLogoBgPath, scaledLogoBgPath;
     Image arrayImage2Ch;
     Image arrayImage4Ch;
     Rectangle<float> arrayImageArea;
     
     Image arrayImage;
     
+    // the background colour, the array image and the logo, everything else repaints itself when it changes
+    Image backgroundImage;
+    float backgroundImageScale = 1.0f;
+    void renderBackgroundImage (float scale);
+    
     LevelMeter inputMeter[4];
     LevelMeter outputMeter[2];
     
@@ -124,14 +130,16 @@ private:
     const float sCardFact = 0.634f;
     const float hCardFact = 0.75f;
     
-    Path bCardPath;
-    Path cardPath;
-    Path sCardPath;
-    Path hCardPath;
-    Path eightPath;
-    Path omniPath;
+    SharedResourcePointer<PatternPaths> patternPaths;
     
+    // the layout follows the processor's change messages, the meters are updated once per frame
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+    void updateMeters();
     void timerCallback() override;
+    
+   #if JUCE_VERSION >= 0x060100
+    VBlankAttachment vBlankAttachment { this, [this] { updateMeters(); } };
+   #endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StereoCreatorAudioProcessorEditor)
 };
@@ -23,14 +23,60 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "AllocationCheck.h"
+
+namespace
+{
+    // source choices of the virtual microphones and the OC-818s they stand for
+    const char* const micSourceNames[] = { "OC-818 1", "OC-818 2", "OC-818 3", "OC-818 4", "OC-818 1 + 2", "OC-818 3 + 4" };
+    const int micSourcePairs[] = { 1, 2, 4, 8, 1 | 2, 4 | 8 };
+    
+    // the OC-818s and virtual microphones follow the parameters of the stereo modes. The editor has no
+    // controls for these 29 parameters yet, they are set from the host's parameter list or automation
+    AudioProcessorValueTreeState::ParameterLayout withVirtualMicParameters (AudioProcessorValueTreeState::ParameterLayout layout)
+    {
+        layout.add(std::make_unique<AudioParameterBool>("virtualMics", "Virtual Microphones", false, "", [](bool value, int maximumStringLength) {return (value) ? "on" : "off";}, nullptr));
+        
+        // by default the odd OC-818s face sideways and the even ones forward, like the left/right and front/back pairs
+        for (int pair = 0; pair < VirtualMicrophones::maxPairs; ++pair)
+            layout.add(std::make_unique<AudioParameterFloat> ("pairAzimuth" + String(pair + 1), "OC-818 " + String(pair + 1) + " Azimuth", NormalisableRange<float> (- 180.0f, 180.0f, 0.5f), pair % 2 == 0 ? 90.0f : 0.0f, "", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr));
+        
+        const float defaultAzimuths[VirtualMicMatrix::maxOutputs] = { 45.0f, - 45.0f, 135.0f, - 135.0f, 0.0f, 180.0f, 90.0f, - 90.0f };
+        for (int mic = 0; mic < VirtualMicMatrix::maxOutputs; ++mic)
+        {
+            const String number(mic + 1);
+            layout.add(std::make_unique<AudioParameterChoice> ("micSource" + number, "Mic " + number + " Source", StringArray(micSourceNames, numElementsInArray(micSourceNames)), 4),
+                       std::make_unique<AudioParameterFloat> ("micPattern" + number, "Mic " + number + " Pattern", NormalisableRange<float> (0.0f, 1.0f, 0.01f), 0.5f, "", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 2); }, nullptr),
+                       std::make_unique<AudioParameterFloat> ("micAzimuth" + number, "Mic " + number + " Azimuth", NormalisableRange<float> (- 180.0f, 180.0f, 0.5f), defaultAzimuths[mic], "", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr));
+        }
+        
+        return layout;
+    }
+    
+    // the output of a stereo mode as a microphone matrix, its further outputs are silent
+    VirtualMicMatrix toVirtualMicMatrix (const MixingMatrix& matrix, float gain)
+    {
+        VirtualMicMatrix result {};
+        for (int out = 0; out < 2; ++out)
+            for (int in = 0; in < 4; ++in)
+                result.gains[out][in] = gain * matrix.gains[out][in];
+        
+        return result;
+    }
+}
 
 //==============================================================================
 StereoCreatorAudioProcessor::StereoCreatorAudioProcessor()
      : AudioProcessor (BusesProperties()
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Pseudo-MS", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Pseudo-Stereo", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("True-MS", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("True-Stereo", juce::AudioChannelSet::stereo(), false)
+                       .withOutput ("Blumlein", juce::AudioChannelSet::stereo(), false)
                        ),
-params(*this, nullptr, "StereoCreator", {
+params(*this, nullptr, "StereoCreator", withVirtualMicParameters({
     std::make_unique<AudioParameterInt> ("stereoMode", "Stereo Mode", 1, 5, 1, "",
                                            [](int value, int maximumStringLength) {return String(value + 1);}, nullptr),
     std::make_unique<AudioParameterFloat> ("msMidGain", "MS Mid Gain", NormalisableRange<float>( - 18.0f, 3.0f, 0.1f), -6.0f,  "dB", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
@@ -46,33 +92,55 @@ params(*this, nullptr, "StereoCreator", {
     std::make_unique<AudioParameterFloat> ("compensationGain2", "Compensation Gain - Pseudo-Stereo", NormalisableRange<float>( - 9.0f, 9.0f, 0.1f), 0.0f,  "dB", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
     std::make_unique<AudioParameterFloat> ("compensationGain3", "Compensation Gain - True-MS", NormalisableRange<float>( - 9.0f, 9.0f, 0.1f), 0.0f,  "dB", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
     std::make_unique<AudioParameterFloat> ("compensationGain4", "Compensation Gain - True-Stereo", NormalisableRange<float>( - 9.0f, 9.0f, 0.1f), 0.0f,  "dB", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
-    std::make_unique<AudioParameterFloat> ("compensationGain5", "Compensation Gain - Blumlein", NormalisableRange<float>( - 9.0f, 9.0f, 0.1f), 0.0f,  "dB", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr)
+    std::make_unique<AudioParameterFloat> ("compensationGain5", "Compensation Gain - Blumlein", NormalisableRange<float>( - 9.0f, 9.0f, 0.1f), 0.0f,  "dB", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
+    std::make_unique<AudioParameterBool>("followLoudness", "Follow Loudness", false, "", [](bool value, int maximumStringLength) {return (value) ? "on" : "off";}, nullptr),
+    std::make_unique<AudioParameterFloat> ("followRiseTime", "Follow Rise Time", NormalisableRange<float> (1.0f, 60.0f, 0.1f), 10.0f, "s", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
+    std::make_unique<AudioParameterFloat> ("followFallTime", "Follow Fall Time", NormalisableRange<float> (1.0f, 60.0f, 0.1f), 5.0f, "s", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr),
+    std::make_unique<AudioParameterFloat> ("followMaxSlew", "Follow Max Slew", NormalisableRange<float> (0.1f, 6.0f, 0.1f), 1.0f, "dB/s", AudioProcessorParameter::genericParameter, [](float value, int maximumStringLength) { return String(value, 1); }, nullptr)
 
-}),
-layerA(nodeA), layerB(nodeB), allValueTreeStates(allStates)
+})),
+layerA(nodeA), layerB(nodeB), allValueTreeStates(allStates), fourChannelKernel(MixingKernels::getFourChannelKernel()), matrixKernel(MixingKernels::getMatrixKernel())
 {
-    params.addParameterListener("stereoMode", this);
-    params.addParameterListener("msMidGain", this);
-    params.addParameterListener("msSideGain", this);
-    params.addParameterListener("channelSwitch", this);
-    params.addParameterListener("calcCompGain", this);
-    params.addParameterListener("msMidPattern", this);
-    params.addParameterListener("trueStXyPattern", this);
-    params.addParameterListener("trueStXyAngle", this);
-    params.addParameterListener("blumleinRot", this);
+    stereoModeIdx = params.getRawParameterValue("stereoMode");
+    channelSwitchOn = params.getRawParameterValue("channelSwitch");
+    autoLevelsOn = params.getRawParameterValue("calcCompGain");
+    msMidGain = params.getRawParameterValue("msMidGain");
+    msSideGain = params.getRawParameterValue("msSideGain");
+    pseudoStPattern = params.getRawParameterValue("pseudoStPattern");
+    msMidPattern = params.getRawParameterValue("msMidPattern");
+    trueStXyPattern = params.getRawParameterValue("trueStXyPattern");
+    trueStXyAngle = params.getRawParameterValue("trueStXyAngle");
+    blumleinRot = params.getRawParameterValue("blumleinRot");
+    followLoudnessOn = params.getRawParameterValue("followLoudness");
+    followRiseTime = params.getRawParameterValue("followRiseTime");
+    followFallTime = params.getRawParameterValue("followFallTime");
+    followMaxSlew = params.getRawParameterValue("followMaxSlew");
+    virtualMicsOn = params.getRawParameterValue("virtualMics");
+    for (int pair = 0; pair < VirtualMicrophones::maxPairs; ++pair)
+        pairAzimuth[pair] = params.getRawParameterValue("pairAzimuth" + String(pair + 1));
+    for (int mic = 0; mic < VirtualMicMatrix::maxOutputs; ++mic)
+    {
+        micSource[mic] = params.getRawParameterValue("micSource" + String(mic + 1));
+        micPattern[mic] = params.getRawParameterValue("micPattern" + String(mic + 1));
+        micAzimuth[mic] = params.getRawParameterValue("micAzimuth" + String(mic + 1));
+    }
     
+    calcCompGainParam = params.getParameter("calcCompGain");
     for (int i = 0; i < 5; i++)
     {
-        params.addParameterListener("compensationGain"+String(i+1), this);
+        compensationGain[i] = params.getRawParameterValue("compensationGain"+String(i+1));
+        compensationGainParam[i] = params.getParameter("compensationGain"+String(i+1));
     }
     
-    stereoModeIdx = params.getRawParameterValue("stereoMode");
-    channelSwitchOn = params.getRawParameterValue("channelSwitch");
-    autoLevelsOn = params.getRawParameterValue("calcCompGain");
+    numInputs = getTotalNumInputChannels();
+    
+    getXyAngleRelatedGains(trueStXyAngle->load());
+    getBlumleinRotationGains(blumleinRot->load());
 }
 
 StereoCreatorAudioProcessor::~StereoCreatorAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -141,9 +209,13 @@ void StereoCreatorAudioProcessor::changeProgramName (int index, const juce::Stri
 void StereoCreatorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
-    currentBlockSize = samplesPerBlock;
     
-    numInputs = getTotalNumInputChannels();
+    if (numInputs != getTotalNumInputChannels())
+    {
+        numInputs = getTotalNumInputChannels();
+        sendChangeMessage();
+    }
+    numMainOutputs = getMainBusNumOutputChannels();
     
     if (numInputs == 4 && stereoModeIdx->load() < eStereoMode::trueMsIdx)
     {
@@ -159,54 +231,50 @@ void StereoCreatorAudioProcessor::prepareToPlay (double sampleRate, int samplesP
 //    else
 //        wrongBusConfiguration = false;
     
-    omniEightLrBuffer.setSize(2, currentBlockSize);
-    omniEightLrBuffer.clear();
-    omniEightFbBuffer.setSize(2, currentBlockSize);
-    omniEightFbBuffer.clear();
-    msLeftRightBuffer.setSize(2, currentBlockSize);
-    msLeftRightBuffer.clear();
-    msMidBuffer.setSize(1, currentBlockSize);
-    msMidBuffer.clear();
-    chSwitchBuffer.setSize(2, currentBlockSize);
-    chSwitchBuffer.clear();
-    passThroughLeftRightBuffer.setSize(2, currentBlockSize);
-    passThroughLeftRightBuffer.clear();
-    rotatedEightLeftRightBuffer.setSize(2, currentBlockSize);
-    rotatedEightLeftRightBuffer.clear();
-    xyLeftRightBuffer.setSize(2, currentBlockSize);
-    xyLeftRightBuffer.clear();
-    blumleinLeftRightBuffer.setSize(2, currentBlockSize);
-    blumleinLeftRightBuffer.clear();
-    
-    getXyAngleRelatedGains(params.getRawParameterValue("trueStXyAngle")->load());
-    previousXyEightRotationGainLeft = currentBlumleinEightRotationGainLeft;
-    previousXyEightRotationGainFront = currentXyEightRotationGainFront;
-    
-    getBlumleinRotationGains(params.getRawParameterValue("blumleinRot")->load());
-    previousBlumleinEightRotationGainFront = currentBlumleinEightRotationGainFront;
-    previousBlumleinEightRotationGainLeft = currentBlumleinEightRotationGainLeft;
-    
-    previousMidGain = Decibels::decibelsToGain(params.getRawParameterValue("msMidGain")->load());
-    previousSideGain = Decibels::decibelsToGain(params.getRawParameterValue("msSideGain")->load());
-    previousPseudoStereoPattern = params.getRawParameterValue("pseudoStPattern")->load();
-    previousMsMidPattern = params.getRawParameterValue("msMidPattern")->load();
-    previousTrueStereoPattern = params.getRawParameterValue("trueStXyPattern")->load();
-    
-    blocksToAverage = secondsToAverage * currentSampleRate / currentBlockSize;
+    // the mixing kernel works in place on the host buffer and needs no scratch memory
+    
+    // the optional output buses carry one mode each, behind the main output
+    numAuxOutputs = 0;
+    for (int mode = 0; mode < 5; ++mode)
+    {
+        const bool isEnabled = getBusCount(false) > mode + 1 && getBus(false, mode + 1)->isEnabled();
+        auxOutputChannels[mode] = isEnabled ? getChannelIndexInProcessBlockBuffer(false, mode + 1, 0) : -1;
+        if (isEnabled)
+            ++numAuxOutputs;
+    }
+    
+    for (auto* smoother : smoothers)
+        smoother->reset(sampleRate, parameterSmoothingTime);
+    
+    crossfadeLength = roundToInt(modeCrossfadeTime * sampleRate);
+    virtualMicRampLength = roundToInt(parameterSmoothingTime * sampleRate);
+    
+    // start without ramps
+    loadParameterSnapshot();
+    overallGainSmoothed.setTargetValue(parameters.compensationGain);
+    updateVirtualMicTarget();
+    skipRamps();
+    
+    loudnessAnalyser.prepare(sampleRate, numInputs, secondsToAverage);
+    followedStereoMode = 0;
 }
 
 void StereoCreatorAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    loudnessAnalyser.release();
 }
 
 bool StereoCreatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    if ((layouts.getMainOutputChannelSet() != AudioChannelSet::stereo()
-        && layouts.getMainOutputChannelSet() != AudioChannelSet::quadraphonic())
-        || (layouts.getMainInputChannelSet() != AudioChannelSet::stereo()
-        && layouts.getMainInputChannelSet() != AudioChannelSet::quadraphonic()))
+    // one to four OC-818s in, stereo or up to eight virtual microphones out
+    const int numInputChannels = layouts.getMainInputChannelSet().size();
+    if (numInputChannels < 2 || numInputChannels > VirtualMicMatrix::maxInputs || numInputChannels % 2 != 0)
+        return false;
+    
+    const int numOutputChannels = layouts.getMainOutputChannelSet().size();
+    if (numOutputChannels < 2 || numOutputChannels > VirtualMicMatrix::maxOutputs)
         return false;
     
     if (layouts.getMainInputChannelSet().isDisabled())
@@ -215,261 +283,146 @@ bool StereoCreatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
     if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
     
+    // the output buses of the single modes are stereo or off
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+        if (! layouts.getChannelSet(false, bus).isDisabled() && layouts.getChannelSet(false, bus) != AudioChannelSet::stereo())
+            return false;
+    
     return true;
 }
 
 void StereoCreatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBuffer(buffer, false);
+}
+
+void StereoCreatorAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBuffer(buffer, false);
+}
+
+void StereoCreatorAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBuffer(buffer, true);
+}
+
+void StereoCreatorAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBuffer(buffer, true);
+}
+
+bool StereoCreatorAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename FloatType>
+void StereoCreatorAudioProcessor::processBuffer (AudioBuffer<FloatType>& buffer, bool bypassed)
 {
     juce::ScopedNoDenormals noDenormals;
+    FORBID_ALLOCATION_IN_SCOPE
     auto totalNumInputChannels  = getTotalNumInputChannels();
 //    auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     int numSamples = buffer.getNumSamples();
     
-    for (int i = 0; i < buffer.getNumChannels(); ++i)
-    {
-        inRms[i] = buffer.getRMSLevel (i, 0, numSamples);
-    }
-    
-    const float* readPointerLeft = buffer.getReadPointer(0);
-    const float* readPointerRight = buffer.getReadPointer(1);
+    if (totalNumInputChannels < 2 || totalNumInputChannels > VirtualMicMatrix::maxInputs || totalNumInputChannels % 2 != 0 || numSamples == 0)
+        return;
     
-    float* writePointerPassThroughLeft = passThroughLeftRightBuffer.getWritePointer(0);
-    float* writePointerPassThroughRight = passThroughLeftRightBuffer.getWritePointer(1);
+    const bool virtualMics = usesVirtualMicrophones();
     
-    float* writePointerOmniLR = omniEightLrBuffer.getWritePointer(0);
-    float* writePointerEightLR = omniEightLrBuffer.getWritePointer(1);
+    // bypassing and returning are crossfaded, once fully bypassed only the channels that aren't passed
+    // through have to be cleared
+    bypassSmoothed.setTargetValue(bypassed ? 1.0f : 0.0f);
     
-    float* writePointerMsLeft = msLeftRightBuffer.getWritePointer(0);
-    float* writePointerMsRight = msLeftRightBuffer.getWritePointer(1);
+    if (bypassed && ! bypassSmoothed.isSmoothing())
+    {
+        for (int ch = virtualMics ? jmin(totalNumInputChannels, numMainOutputs) : 2; ch < buffer.getNumChannels(); ++ch)
+            buffer.clear(ch, 0, numSamples);
+        
+        blockLevels = BlockLevels();
+        updateMeters(numSamples);
+        return;
+    }
     
-    FloatVectorOperations::copy (writePointerOmniLR, readPointerLeft, numSamples);
-    FloatVectorOperations::add (writePointerOmniLR, readPointerRight, numSamples);
+    loadParameterSnapshot();
+    const ProcessFunction<FloatType> processFunction = getProcessFunction<FloatType>(parameters.stereoMode, totalNumInputChannels, parameters.channelsSwapped);
     
-    FloatVectorOperations::copy (writePointerEightLR, readPointerLeft, numSamples);
-    FloatVectorOperations::subtract (writePointerEightLR, readPointerRight, numSamples);
+    // the input is only analysed while a calculation or the following needs it, switching either on
+    // starts a new measurement
+    const bool measuresLoudness = ! virtualMics && (parameters.calcCompensationGain || parameters.followLoudness);
+    loudnessAnalyser.setActive(measuresLoudness);
     
-    auto currentMidGain = Decibels::decibelsToGain(params.getRawParameterValue("msMidGain")->load());
-    auto currentSideGain = Decibels::decibelsToGain(params.getRawParameterValue("msSideGain")->load());
-    auto currentPseudoStereoPattern = params.getRawParameterValue("pseudoStPattern")->load();
+    // the result of a calculation is applied right away, until the message thread has published it
+    const bool compensationGainPending = isCompensationGainPending.load(std::memory_order_acquire);
     
-    // one OC-818 was used, ms is calculated with left/right signals
-    if (totalNumInputChannels == 2)
+    if (parameters.followLoudness)
     {
-        switch ((int) stereoModeIdx->load())
-        {
-            case eStereoMode::pseudoMsIdx: // when ms is chosen
-                // applying mid gain
-                applyGainWithRamp(previousMidGain, currentMidGain, &omniEightLrBuffer, 0, numSamples);
-                previousMidGain = currentMidGain;
-                
-                // apply side gain
-                applyGainWithRamp(previousSideGain, currentSideGain, &omniEightLrBuffer, 1, numSamples);
-                previousSideGain = currentSideGain;
-                
-                // creating ms left and right patterns
-                FloatVectorOperations::copy(writePointerMsLeft, writePointerOmniLR, numSamples);
-                FloatVectorOperations::add(writePointerMsLeft, writePointerEightLR, numSamples);
-                
-                FloatVectorOperations::copy(writePointerMsRight, writePointerOmniLR, numSamples);
-                FloatVectorOperations::subtract(writePointerMsRight, writePointerEightLR, numSamples);
-                
-                buffer.copyFrom(0, 0, msLeftRightBuffer, 0, 0, numSamples);
-                buffer.copyFrom(1, 0, msLeftRightBuffer, 1, 0, numSamples);
-                break;
-                
-            case eStereoMode::pseudoStereoIdx: // when pseudo-stereo is chosen
-                // applying pattern weights
-                applyGainWithRamp(1.0f - previousPseudoStereoPattern, 1.0f - currentPseudoStereoPattern, &omniEightLrBuffer, 0, numSamples);
-                applyGainWithRamp(previousPseudoStereoPattern, currentPseudoStereoPattern, &omniEightLrBuffer, 1, numSamples);
-                previousPseudoStereoPattern = currentPseudoStereoPattern;
-                
-                // merging omni and eight to obtain patterns
-                FloatVectorOperations::copy(writePointerPassThroughLeft, writePointerOmniLR, numSamples);
-                FloatVectorOperations::add(writePointerPassThroughLeft, writePointerEightLR, numSamples);
-                
-                FloatVectorOperations::copy(writePointerPassThroughRight, writePointerOmniLR, numSamples);
-                FloatVectorOperations::subtract(writePointerPassThroughRight, writePointerEightLR, numSamples);
-                
-                buffer.copyFrom(0, 0, passThroughLeftRightBuffer, 0, 0, numSamples);
-                buffer.copyFrom(1, 0, passThroughLeftRightBuffer, 1, 0, numSamples);
-                break;
-                
-            default:
-                break;
-        }
-
+        currentOverallGain = Decibels::decibelsToGain(followLoudness(numSamples));
     }
-    // two OC-818 were used, ms is calculated from left/right and front/back signals
-    else if (totalNumInputChannels == 4)
+    else
     {
-        // initialising pointer for further calculations
-        const float* readPointerFront = buffer.getReadPointer(2);
-        const float* readPointerBack = buffer.getReadPointer(3);
-        
-        float* writePointerMsMid = msMidBuffer.getWritePointer(0);
-        
-        float* writePointerOmniFB = omniEightFbBuffer.getWritePointer(0);
-        float* writePointerEightFB = omniEightFbBuffer.getWritePointer(1);
-        
-        float* writePointerRotatedEightLeft = rotatedEightLeftRightBuffer.getWritePointer(0);
-        float* writePointerRotatedEightRight = rotatedEightLeftRightBuffer.getWritePointer(1);
-        
-        float* writePointerXyLeft = xyLeftRightBuffer.getWritePointer(0);
-        float* writePointerXyRight = xyLeftRightBuffer.getWritePointer(1);
-        
-        float* writePointerBlumleinLeft = blumleinLeftRightBuffer.getWritePointer(0);
-        float* writePointerBlumleinRight = blumleinLeftRightBuffer.getWritePointer(1);
-        
-        FloatVectorOperations::copy (writePointerOmniFB, readPointerFront, numSamples);
-        FloatVectorOperations::add (writePointerOmniFB, readPointerBack, numSamples);
-        
-        FloatVectorOperations::copy (writePointerEightFB, readPointerFront, numSamples);
-        FloatVectorOperations::subtract (writePointerEightFB, readPointerBack, numSamples);
-        
-        auto currentMsMidPattern = params.getRawParameterValue("msMidPattern")->load();
-        auto currentTrueStereoPattern = params.getRawParameterValue("trueStXyPattern")->load();
+        followedStereoMode = 0;
         
-        switch ((int) stereoModeIdx->load())
-        {
-            case eStereoMode::trueMsIdx:
-                FloatVectorOperations::copy(writePointerMsMid, writePointerEightFB, numSamples);
-                
-                // applying pattern weights
-                applyGainWithRamp(previousMsMidPattern, currentMsMidPattern, &msMidBuffer, 0, numSamples);
-                applyGainWithRamp(1.0f - previousMsMidPattern, 1.0f - currentMsMidPattern, &omniEightFbBuffer, 0, numSamples);
-                previousMsMidPattern = currentMsMidPattern;
-                
-                // calculating mid pattern
-                FloatVectorOperations::add(writePointerMsMid, writePointerOmniFB, numSamples);
-                
-                // applying mid gain
-                applyGainWithRamp(previousMidGain, currentMidGain, &msMidBuffer, 0, numSamples);
-                previousMidGain = currentMidGain;
-                
-                // apply side gain
-                applyGainWithRamp(previousSideGain, currentSideGain, &omniEightLrBuffer, 1, numSamples);
-                previousSideGain = currentSideGain;
-                
-                // calculating left and right ms-channel
-                FloatVectorOperations::copy(writePointerMsLeft, writePointerMsMid, numSamples);
-                FloatVectorOperations::add(writePointerMsLeft, writePointerEightLR, numSamples);
-                
-                FloatVectorOperations::copy(writePointerMsRight, writePointerMsMid, numSamples);
-                FloatVectorOperations::subtract(writePointerMsRight, writePointerEightLR, numSamples);
-                
-                // writing result to output buffer
-                buffer.copyFrom(0, 0, msLeftRightBuffer, 0, 0, numSamples);
-                buffer.copyFrom(1, 0, msLeftRightBuffer, 1, 0, numSamples);
-                break;
-                
-            case eStereoMode::trueStereoIdx:
-                
-                applyGainWithRamp(previousXyEightRotationGainFront, currentXyEightRotationGainFront, &omniEightFbBuffer, 1, numSamples);
-                applyGainWithRamp(previousXyEightRotationGainLeft, currentXyEightRotationGainLeft, &omniEightLrBuffer, 1, numSamples);
-                
-                FloatVectorOperations::copy(writePointerRotatedEightLeft, writePointerEightFB, numSamples);
-                FloatVectorOperations::add(writePointerRotatedEightLeft, writePointerEightLR, numSamples);
-                
-                FloatVectorOperations::copy(writePointerRotatedEightRight, writePointerEightFB, numSamples);
-                FloatVectorOperations::subtract(writePointerRotatedEightRight, writePointerEightLR, numSamples);
-                
-                applyGainWithRamp(previousTrueStereoPattern, currentTrueStereoPattern, &rotatedEightLeftRightBuffer, 0, numSamples);
-                applyGainWithRamp(previousTrueStereoPattern, currentTrueStereoPattern, &rotatedEightLeftRightBuffer, 1, numSamples);
-                applyGainWithRamp(1.0f - previousTrueStereoPattern, 1.0f - currentTrueStereoPattern, &omniEightFbBuffer, 0, numSamples);
-                previousTrueStereoPattern = currentTrueStereoPattern;
-                previousXyEightRotationGainFront = currentXyEightRotationGainFront;
-                previousXyEightRotationGainLeft = currentXyEightRotationGainLeft;
-                
-                FloatVectorOperations::copy(writePointerXyLeft, writePointerRotatedEightLeft, numSamples);
-                FloatVectorOperations::add(writePointerXyLeft, writePointerOmniFB, numSamples);
-                
-                FloatVectorOperations::copy(writePointerXyRight, writePointerRotatedEightRight, numSamples);
-                FloatVectorOperations::add(writePointerXyRight, writePointerOmniFB, numSamples);
-                
-                buffer.copyFrom(0, 0, xyLeftRightBuffer, 0, 0, numSamples);
-                buffer.copyFrom(1, 0, xyLeftRightBuffer, 1, 0, numSamples);
-                break;
-                
-            case eStereoMode::blumleinIdx:
-                // preparing left blumlein channel with FB eight
-                FloatVectorOperations::copy(writePointerBlumleinLeft, writePointerEightFB, numSamples);
-                // preparing right blumlein channel with negative LR eight
-                FloatVectorOperations::copyWithMultiply(writePointerBlumleinRight, writePointerEightLR, - 1.0f, numSamples);
-                
-                // applying FB eight rotation gain for left blumlein channel (copy of FB eight)
-                applyGainWithRamp(previousBlumleinEightRotationGainLeft, currentBlumleinEightRotationGainLeft, &blumleinLeftRightBuffer, 0, numSamples);
-                // applying LR eight rotation gain for LR eight
-                applyGainWithRamp(previousBlumleinEightRotationGainFront, currentBlumleinEightRotationGainFront, &omniEightLrBuffer, 1, numSamples);
-                // adding manipulated FB eight (left blumlein Ch) and LR eight (original LR eight)
-                FloatVectorOperations::add(writePointerBlumleinLeft, writePointerEightLR, numSamples);
-                
-                // applying LR eight rotation gain for right blumlein channel (copy of LR eight)
-                applyGainWithRamp(previousBlumleinEightRotationGainLeft, currentBlumleinEightRotationGainLeft, &blumleinLeftRightBuffer, 1, numSamples);
-                // applying FB eight rotation gain for FB eight
-                applyGainWithRamp(previousBlumleinEightRotationGainFront, currentBlumleinEightRotationGainFront, &omniEightFbBuffer, 1, numSamples);
-                // adding manipulated LR eight (right blumlein Ch) and FB eight (original FB eight)
-                FloatVectorOperations::add(writePointerBlumleinRight, writePointerEightFB, numSamples);
-                
-                // resetting gains
-                previousBlumleinEightRotationGainLeft = currentBlumleinEightRotationGainLeft;
-                previousBlumleinEightRotationGainFront = currentBlumleinEightRotationGainFront;
-                
-                buffer.copyFrom(0, 0, blumleinLeftRightBuffer, 0, 0, numSamples);
-                buffer.copyFrom(1, 0, blumleinLeftRightBuffer, 1, 0, numSamples);
-                break;
-            default:
-                break;
-        }
-        buffer.clear(2, 0, numSamples);
-        buffer.clear(3, 0, numSamples);
+        if (compensationGainPending)
+            currentOverallGain = pendingCompensationGains[parameters.stereoMode - 1];
+        else
+            currentOverallGain = parameters.compensationGain;
     }
-    else
+    
+    overallGainSmoothed.setTargetValue(currentOverallGain);
+    
+    // the output buses of the single modes get the gains the main output would apply in their mode. Only the
+    // active mode is followed, its bus gets the smoothed gain of the main output in process()
+    if (numAuxOutputs > 0 && compensationGainPending)
+        for (int mode = 0; mode < 5; ++mode)
+            auxCompensationGains[mode] = pendingCompensationGains[mode];
+    
+    // silence in gives silence out, only the meters have to fall. The ramps wouldn't be audible, so they
+    // are finished right away
+    if (isSilent(buffer, totalNumInputChannels))
     {
+        buffer.clear();
+        skipRamps();
+        blockLevels = BlockLevels();
+        updateMeters(numSamples);
         return;
     }
     
-    if (channelSwitchOn->load() >= 0.5f)
-    {
-        chSwitchBuffer.copyFrom(0, 0, buffer, 1, 0, numSamples);
-        chSwitchBuffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
-        buffer.copyFrom(0, 0, chSwitchBuffer, 0, 0, numSamples);
-        buffer.copyFrom(1, 0, chSwitchBuffer, 1, 0, numSamples);
-    }
+    if (virtualMics && (! isProcessingVirtualMicrophones || isLeavingVirtualMicrophones))
+        startVirtualMicrophones();
+    else if (! virtualMics && isProcessingVirtualMicrophones && ! isLeavingVirtualMicrophones)
+        stopVirtualMicrophones();
     
-    if (autoLevelsOn->load() >= 0.5f)
+    if (isProcessingVirtualMicrophones)
     {
-        if (counter == blocksToAverage)
-        {
-            float newOverallGain = (inputGainMean / outGainMean);
-            newOverallGain = Decibels::gainToDecibels(newOverallGain);
-            
-            params.getParameter("compensationGain"+String(stereoModeIdx->load()))->setValueNotifyingHost(params.getParameter("compensationGain"+String(stereoModeIdx->load()))->convertTo0to1(newOverallGain));
-            
-            params.getParameter("calcCompGain")->setValueNotifyingHost(false);
-            inputGainMean = 0.000001f;
-            outGainMean = 0.000001f;
-            counter = 0;
-        }
-        else
-        {
-            inputGainMean += (inRms[0].get() + inRms[1].get()) / 2.0f;
-            outGainMean += (outRms[0].get() + outRms[1].get()) / 2.0f / (currentOverallGain + 0.000001f);
-            counter++;
-        }
+        processVirtualMicrophones(buffer, numSamples);
+        updateMeters(numSamples);
+        
+        if (isLeavingVirtualMicrophones && virtualMicSamplesRemaining == 0)
+            isProcessingVirtualMicrophones = isLeavingVirtualMicrophones = false;
+        return;
     }
     
-    currentOverallGain = Decibels::decibelsToGain(params.getRawParameterValue("compensationGain"+String(stereoModeIdx->load()))->load());
-    applyGainWithRamp(previousOverallGain, currentOverallGain, &buffer, 0, numSamples);
-    applyGainWithRamp(previousOverallGain, currentOverallGain, &buffer, 1, numSamples);
-    previousOverallGain = currentOverallGain;
+    if (measuresLoudness)
+        loudnessAnalyser.pushSamples(buffer, numSamples);
+    
+    (this->*processFunction)(buffer, numSamples);
     
-    outRms[0] = buffer.getRMSLevel(0, 0, numSamples);
-    outRms[1] = buffer.getRMSLevel(1, 0, numSamples);
+    // the stereo modes only write the first two outputs. Four OC-818s clear their back channels in the
+    // kernel, with two the further outputs would keep what the host left in them
+    for (int ch = totalNumInputChannels; ch < numMainOutputs; ++ch)
+        buffer.clear(ch, 0, numSamples);
     
-    jassert(buffer.getRMSLevel(0, 0, numSamples) <= 1.1f);
-    jassert(buffer.getRMSLevel(1, 0, numSamples) <= 1.1f);
+    updateMeters(numSamples);
     
+    jassert(blockOutputRms[0] <= 1.1f);
+    jassert(blockOutputRms[1] <= 1.1f);
+    
+    // the gains of all modes are calculated at once, as soon as the gated measurement covers secondsToAverage
+    InputCovariance inputCovariance;
+    if (parameters.calcCompensationGain && ! compensationGainPending && loudnessAnalyser.getGatedCovariance(inputCovariance))
+        calcCompensationGains(inputCovariance);
 }
 
 //==============================================================================
@@ -531,37 +484,22 @@ void StereoCreatorAudioProcessor::setStateInformation (const void* data, int siz
     }
 }
 
-void StereoCreatorAudioProcessor::parameterChanged(const String &parameterID, float newValue)
-{
-    if (parameterID == "trueStXyAngle")
-    {
-        getXyAngleRelatedGains(params.getRawParameterValue("trueStXyAngle")->load());
-    }
-    else if (parameterID == "blumleinRot")
-    {
-        getBlumleinRotationGains(params.getRawParameterValue("blumleinRot")->load());
-    }
-    else if (parameterID == "stereoMode")
-    {
-        previousOverallGain = 0.0001f; //currentOverallGain;
-        currentOverallGain = Decibels::decibelsToGain(params.getRawParameterValue("compensationGain"+String(stereoModeIdx->load()))->load());
-    }
-}
-
 void StereoCreatorAudioProcessor::getXyAngleRelatedGains(float currentAngle)
 {
     float angle = currentAngle / 2.0f;
     
-    currentXyEightRotationGainFront = cos(angle * MathConstants<float>::pi / 180.0f);
-    currentXyEightRotationGainLeft = sin(angle * MathConstants<float>::pi / 180.0f);
+    parameters.xyAngle = currentAngle;
+    parameters.xyEightRotationGainFront = cos(angle * MathConstants<float>::pi / 180.0f);
+    parameters.xyEightRotationGainLeft = sin(angle * MathConstants<float>::pi / 180.0f);
 }
 
 void StereoCreatorAudioProcessor::getBlumleinRotationGains(float currentRotation)
 {
     float angle = currentRotation + 45.0f;
     
-    currentBlumleinEightRotationGainFront = cos(angle * MathConstants<float>::pi / 180.0f);
-    currentBlumleinEightRotationGainLeft = sin(angle * MathConstants<float>::pi / 180.0f);
+    parameters.blumleinRotation = currentRotation;
+    parameters.blumleinEightRotationGainFront = cos(angle * MathConstants<float>::pi / 180.0f);
+    parameters.blumleinEightRotationGainLeft = sin(angle * MathConstants<float>::pi / 180.0f);
     
 }
 
@@ -595,15 +533,770 @@ void StereoCreatorAudioProcessor::changeAbLayerState()
     }
 }
 
-void StereoCreatorAudioProcessor::applyGainWithRamp(float previousGain, float currentGain, AudioBuffer<float>* buff, int bufferChannel, int numSamples)
+float StereoCreatorAudioProcessor::calcCompensationGainInDecibels(int stereoMode, const InputCovariance& inputCovariance)
+{
+    MixingMatrix matrix;
+    calcMixingMatrix(stereoMode, numInputs, matrix);
+    
+    // the K-weighted power of the left/right outputs is matched to the one of the left/right inputs,
+    // which is their loudness over the gated blocks
+    const double inputPower = inputCovariance.values[0][0] + inputCovariance.values[1][1];
+    double outputPower = 0.0;
+    for (int out = 0; out < 2; ++out)
+        for (int row = 0; row < 4; ++row)
+            for (int column = 0; column < 4; ++column)
+                outputPower += matrix.gains[out][row] * inputCovariance.values[row][column] * matrix.gains[out][column];
+    
+    if (inputPower <= 0.0 || outputPower <= 0.0)
+        return 0.0f;
+    
+    // limited to the range of the parameter
+    auto* compensationGainOfMode = compensationGainParam[stereoMode - 1];
+    const float gainInDecibels = (float) (10.0 * std::log10(inputPower / outputPower));
+    return compensationGainOfMode->convertFrom0to1(compensationGainOfMode->convertTo0to1(gainInDecibels));
+}
+
+float StereoCreatorAudioProcessor::followLoudness(int numSamples)
+{
+    // following starts from the gain of the mode, whenever it is switched on or the mode changes
+    if (followedStereoMode != parameters.stereoMode)
+    {
+        followedStereoMode = parameters.stereoMode;
+        followedGainInDecibels = compensationGain[parameters.stereoMode - 1]->load();
+        followTargetInDecibels = followedGainInDecibels;
+    }
+    
+    // the target is held while the measurement is incomplete, e.g. during silence
+    InputCovariance inputCovariance;
+    if (loudnessAnalyser.getGatedCovariance(inputCovariance))
+        followTargetInDecibels = calcCompensationGainInDecibels(parameters.stereoMode, inputCovariance);
+    
+    const float difference = followTargetInDecibels - followedGainInDecibels;
+    const float timeConstant = difference > 0.0f ? parameters.followRiseTime : parameters.followFallTime;
+    const float step = difference * (1.0f - std::exp(- numSamples / (timeConstant * (float) currentSampleRate)));
+    const float maxStep = parameters.followMaxSlew * numSamples / (float) currentSampleRate;
+    
+    followedGainInDecibels += jlimit(- maxStep, maxStep, step);
+    return followedGainInDecibels;
+}
+
+void StereoCreatorAudioProcessor::calcCompensationGains(const InputCovariance& inputCovariance)
+{
+    // with two inputs, only the pseudo modes can be used
+    const int numModes = numInputs == 4 ? 5 : 2;
+    
+    int start1, size1, start2, size2;
+    compensationGainFifo.prepareToWrite(numModes, start1, size1, start2, size2);
+    if (size1 + size2 < numModes)
+        return;
+    
+    for (int mode = 0; mode < 5; ++mode)
+    {
+        if (mode < numModes)
+        {
+            const float gainInDecibels = calcCompensationGainInDecibels(mode + 1, inputCovariance);
+            compensationGainResults[mode < size1 ? start1 + mode : start2 + mode - size1] = { mode + 1, gainInDecibels };
+            pendingCompensationGains[mode] = Decibels::decibelsToGain(gainInDecibels);
+        }
+        else
+        {
+            pendingCompensationGains[mode] = Decibels::decibelsToGain(compensationGain[mode]->load());
+        }
+    }
+    
+    compensationGainFifo.finishedWrite(numModes);
+    isCompensationGainPending.store(true, std::memory_order_release);
+    
+    // posting the message may allocate on some platforms
+    ALLOW_ALLOCATION_IN_SCOPE
+    triggerAsyncUpdate();
+}
+
+void StereoCreatorAudioProcessor::handleAsyncUpdate()
+{
+    int start1, size1, start2, size2;
+    compensationGainFifo.prepareToRead(compensationGainFifo.getNumReady(), start1, size1, start2, size2);
+    
+    for (int i = 0; i < size1 + size2; ++i)
+    {
+        const auto& result = compensationGainResults[i < size1 ? start1 + i : start2 + i - size1];
+        auto* compensationGainOfMode = compensationGainParam[result.stereoMode - 1];
+        compensationGainOfMode->setValueNotifyingHost(compensationGainOfMode->convertTo0to1(result.gainInDecibels));
+    }
+    
+    compensationGainFifo.finishedRead(size1 + size2);
+    
+    calcCompGainParam->setValueNotifyingHost(false);
+    isCompensationGainPending.store(false, std::memory_order_release);
+}
+
+void StereoCreatorAudioProcessor::loadParameterSnapshot()
+{
+    parameters.stereoMode = jlimit(1, 5, (int) stereoModeIdx->load());
+    parameters.channelsSwapped = channelSwitchOn->load() >= 0.5f;
+    parameters.calcCompensationGain = autoLevelsOn->load() >= 0.5f;
+    parameters.compensationGain = Decibels::decibelsToGain(compensationGain[parameters.stereoMode - 1]->load());
+    parameters.followLoudness = followLoudnessOn->load() >= 0.5f;
+    parameters.followRiseTime = followRiseTime->load();
+    parameters.followFallTime = followFallTime->load();
+    parameters.followMaxSlew = followMaxSlew->load();
+    
+    if (numAuxOutputs > 0)
+        for (int mode = 0; mode < 5; ++mode)
+            auxCompensationGains[mode] = Decibels::decibelsToGain(compensationGain[mode]->load());
+    
+    // the matrix parameters are targets of the smoothers, advanceParameterSmoothing() writes the smoothed values
+    midGainSmoothed.setTargetValue(Decibels::decibelsToGain(msMidGain->load()));
+    sideGainSmoothed.setTargetValue(Decibels::decibelsToGain(msSideGain->load()));
+    pseudoStereoPatternSmoothed.setTargetValue(pseudoStPattern->load());
+    msMidPatternSmoothed.setTargetValue(msMidPattern->load());
+    trueStereoPatternSmoothed.setTargetValue(trueStXyPattern->load());
+    xyAngleSmoothed.setTargetValue(trueStXyAngle->load());
+    blumleinRotationSmoothed.setTargetValue(blumleinRot->load());
+}
+
+void StereoCreatorAudioProcessor::advanceParameterSmoothing(int numSamples)
+{
+    parameters.midGain = midGainSmoothed.skip(numSamples);
+    parameters.sideGain = sideGainSmoothed.skip(numSamples);
+    parameters.pseudoStereoPattern = pseudoStereoPatternSmoothed.skip(numSamples);
+    parameters.msMidPattern = msMidPatternSmoothed.skip(numSamples);
+    parameters.trueStereoPattern = trueStereoPatternSmoothed.skip(numSamples);
+    
+    // the rotation gains are derived from the smoothed angles, so both gains of a pair always belong together
+    const float xyAngle = xyAngleSmoothed.skip(numSamples);
+    if (xyAngle != parameters.xyAngle)
+        getXyAngleRelatedGains(xyAngle);
+    
+    const float blumleinRotation = blumleinRotationSmoothed.skip(numSamples);
+    if (blumleinRotation != parameters.blumleinRotation)
+        getBlumleinRotationGains(blumleinRotation);
+}
+
+void StereoCreatorAudioProcessor::skipRamps()
+{
+    for (auto* smoother : smoothers)
+        smoother->setCurrentAndTargetValue(smoother->getTargetValue());
+    
+    advanceParameterSmoothing(0);
+    
+    // the microphone gains take some trigonometry, on silence they are only refreshed while they are used
+    if (usesVirtualMicrophones())
+        updateVirtualMicTarget();
+    
+    virtualMicMatrix = virtualMicTarget;
+    previousVirtualMicMatrix = virtualMicTarget;
+    virtualMicSamplesRemaining = 0;
+    isProcessingVirtualMicrophones = usesVirtualMicrophones();
+    isLeavingVirtualMicrophones = false;
+    
+    resetMixingRamp();
+    
+    for (int mode = 0; mode < 5; ++mode)
+        if (auxOutputChannels[mode] >= 0)
+            calcAuxMixingMatrix(mode + 1, numInputs, bypassSmoothed.getCurrentValue(), auxPreviousMatrices[mode]);
+}
+
+template <typename FloatType>
+bool StereoCreatorAudioProcessor::isSilent(const AudioBuffer<FloatType>& buffer, int numChannels) const
+{
+    if (buffer.hasBeenCleared())
+        return true;
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        if (buffer.getMagnitude(ch, 0, buffer.getNumSamples()) > silenceThreshold)
+            return false;
+    
+    return true;
+}
+
+void StereoCreatorAudioProcessor::calcMixingMatrix(int stereoMode, int numInputChannels, MixingMatrix& matrix)
+{
+    // passing left/right through when the mode doesn't fit the number of inputs
+    matrix.setRow(0, 1.0f, 0.0f);
+    matrix.setRow(1, 0.0f, 1.0f);
+    
+    // one OC-818 was used, ms is calculated with left/right signals. With two of them, the pseudo modes use
+    // the left/right signals of the first one, for the output buses of the single modes
+    switch (stereoMode)
+    {
+        case eStereoMode::pseudoMsIdx:
+        {
+            // mid is the omni (L + R), side the eight (L - R)
+            const float midGain = parameters.midGain;
+            const float sideGain = parameters.sideGain;
+            matrix.setRow(0, midGain + sideGain, midGain - sideGain);
+            matrix.setRow(1, midGain - sideGain, midGain + sideGain);
+            break;
+        }
+        case eStereoMode::pseudoStereoIdx:
+        {
+            // (1 - pattern) * omni +/- pattern * eight
+            const float pattern = parameters.pseudoStereoPattern;
+            matrix.setRow(0, 1.0f, 1.0f - 2.0f * pattern);
+            matrix.setRow(1, 1.0f - 2.0f * pattern, 1.0f);
+            break;
+        }
+        default:
+            break;
+    }
+    
+    // two OC-818 were used, ms is calculated from left/right and front/back signals
+    if (numInputChannels == 4)
+    {
+        switch (stereoMode)
+        {
+            case eStereoMode::trueMsIdx:
+            {
+                // mid pattern from the front/back omni and eight, side is the left/right eight
+                const float midGain = parameters.midGain;
+                const float sideGain = parameters.sideGain;
+                const float midPattern = parameters.msMidPattern;
+                const float midBack = midGain * (1.0f - 2.0f * midPattern);
+                matrix.setRow(0, sideGain, - sideGain, midGain, midBack);
+                matrix.setRow(1, - sideGain, sideGain, midGain, midBack);
+                break;
+            }
+            case eStereoMode::trueStereoIdx:
+            {
+                // front/back omni plus the eights rotated by half the recording angle
+                const float pattern = parameters.trueStereoPattern;
+                const float eightLeft = pattern * parameters.xyEightRotationGainLeft;
+                const float eightFront = pattern * parameters.xyEightRotationGainFront;
+                const float omni = 1.0f - pattern;
+                matrix.setRow(0, eightLeft, - eightLeft, omni + eightFront, omni - eightFront);
+                matrix.setRow(1, - eightLeft, eightLeft, omni + eightFront, omni - eightFront);
+                break;
+            }
+            case eStereoMode::blumleinIdx:
+            {
+                // two eights, rotated by +/- 45 degrees plus the blumlein rotation
+                const float gainFront = parameters.blumleinEightRotationGainFront;
+                const float gainLeft = parameters.blumleinEightRotationGainLeft;
+                matrix.setRow(0, gainFront, - gainFront, gainLeft, - gainLeft);
+                matrix.setRow(1, - gainLeft, gainLeft, gainFront, - gainFront);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+void StereoCreatorAudioProcessor::calcMainMixingMatrix(int stereoMode, int numInputChannels, MixingMatrix& matrix)
+{
+    if (numInputChannels == 4 && stereoMode < eStereoMode::trueMsIdx)
+    {
+        matrix.setRow(0, 1.0f, 0.0f);
+        matrix.setRow(1, 0.0f, 1.0f);
+        return;
+    }
+    
+    calcMixingMatrix(stereoMode, numInputChannels, matrix);
+}
+
+template <typename FloatType>
+StereoCreatorAudioProcessor::ProcessFunction<FloatType> StereoCreatorAudioProcessor::getProcessFunction(int stereoMode, int numInputChannels, bool channelsSwapped)
+{
+    static const ProcessFunction<FloatType> processFunctions[5][2][2] =
+    {
+        { { &StereoCreatorAudioProcessor::process<FloatType, pseudoMsIdx, 2, false>, &StereoCreatorAudioProcessor::process<FloatType, pseudoMsIdx, 2, true> },
+          { &StereoCreatorAudioProcessor::process<FloatType, pseudoMsIdx, 4, false>, &StereoCreatorAudioProcessor::process<FloatType, pseudoMsIdx, 4, true> } },
+        { { &StereoCreatorAudioProcessor::process<FloatType, pseudoStereoIdx, 2, false>, &StereoCreatorAudioProcessor::process<FloatType, pseudoStereoIdx, 2, true> },
+          { &StereoCreatorAudioProcessor::process<FloatType, pseudoStereoIdx, 4, false>, &StereoCreatorAudioProcessor::process<FloatType, pseudoStereoIdx, 4, true> } },
+        { { &StereoCreatorAudioProcessor::process<FloatType, trueMsIdx, 2, false>, &StereoCreatorAudioProcessor::process<FloatType, trueMsIdx, 2, true> },
+          { &StereoCreatorAudioProcessor::process<FloatType, trueMsIdx, 4, false>, &StereoCreatorAudioProcessor::process<FloatType, trueMsIdx, 4, true> } },
+        { { &StereoCreatorAudioProcessor::process<FloatType, trueStereoIdx, 2, false>, &StereoCreatorAudioProcessor::process<FloatType, trueStereoIdx, 2, true> },
+          { &StereoCreatorAudioProcessor::process<FloatType, trueStereoIdx, 4, false>, &StereoCreatorAudioProcessor::process<FloatType, trueStereoIdx, 4, true> } },
+        { { &StereoCreatorAudioProcessor::process<FloatType, blumleinIdx, 2, false>, &StereoCreatorAudioProcessor::process<FloatType, blumleinIdx, 2, true> },
+          { &StereoCreatorAudioProcessor::process<FloatType, blumleinIdx, 4, false>, &StereoCreatorAudioProcessor::process<FloatType, blumleinIdx, 4, true> } }
+    };
+    
+    return processFunctions[jlimit(1, 5, stereoMode) - 1][numInputChannels == 4 ? 1 : 0][channelsSwapped ? 1 : 0];
+}
+
+template <typename FloatType, int stereoMode, int numInputChannels, bool channelsSwapped>
+void StereoCreatorAudioProcessor::process(AudioBuffer<FloatType>& buffer, int numSamples)
+{
+    if (stereoMode != previousStereoModeIdx)
+    {
+        crossfadeSourceMatrix = previousMatrix;
+        crossfadeSamplesRemaining = crossfadeLength;
+        previousStereoModeIdx = stereoMode;
+    }
+    
+    blockLevels = BlockLevels();
+    
+    // the host block is split into tiles whose samples stay in the L1 cache, whatever the host's block size is.
+    // the matrix is calculated from the smoothed parameters at the end of each tile and interpolated in between
+    FloatType* channels[4];
+    FloatType inputTile[4][tileSize];
+    for (int start = 0; start < numSamples; start += tileSize)
+    {
+        const int tileLength = jmin(tileSize, numSamples - start);
+        
+        advanceParameterSmoothing(tileLength);
+        calcMainMixingMatrix(stereoMode, numInputChannels, currentMatrix);
+        
+        // the channel swap is part of the output matrix
+        if (channelsSwapped)
+            std::swap(currentMatrix.gains[0], currentMatrix.gains[1]);
+        
+        if (crossfadeSamplesRemaining > 0)
+        {
+            crossfadeSamplesRemaining = jmax(0, crossfadeSamplesRemaining - tileLength);
+            const float progress = 1.0f - (float) crossfadeSamplesRemaining / crossfadeLength;
+            
+            for (int out = 0; out < 2; ++out)
+                for (int in = 0; in < 4; ++in)
+                    currentMatrix.gains[out][in] = crossfadeSourceMatrix.gains[out][in] + progress * (currentMatrix.gains[out][in] - crossfadeSourceMatrix.gains[out][in]);
+        }
+        
+        float overallGain = overallGainSmoothed.skip(tileLength);
+        auxCompensationGains[stereoMode - 1] = overallGain;
+        
+        // while bypassing, the overall gain is part of the matrix, which is blended with the passthrough
+        const float bypassAmount = bypassSmoothed.skip(tileLength);
+        if (bypassAmount > 0.0f)
+        {
+            for (int out = 0; out < 2; ++out)
+                for (int in = 0; in < 4; ++in)
+                    currentMatrix.gains[out][in] = (1.0f - bypassAmount) * overallGain * currentMatrix.gains[out][in] + (out == in ? bypassAmount : 0.0f);
+            
+            overallGain = 1.0f;
+        }
+        
+        MixingRamp ramp = makeMixingRamp(overallGain, tileLength);
+        
+        for (int ch = 0; ch < numInputChannels; ++ch)
+            channels[ch] = buffer.getWritePointer(ch, start);
+        
+        // the inputs are read once per tile for all modes, the main kernel overwrites them in place
+        if (numAuxOutputs > 0)
+            for (int ch = 0; ch < numInputChannels; ++ch)
+                FloatVectorOperations::copy(inputTile[ch], channels[ch], tileLength);
+        
+        processTile<FloatType, numInputChannels>(channels, tileLength, ramp, blockLevels);
+        
+        if (numAuxOutputs > 0)
+            processAuxOutputs<FloatType, numInputChannels>(buffer, start, tileLength, inputTile, bypassAmount);
+        
+        previousMatrix = currentMatrix;
+        previousOverallGain = overallGain;
+    }
+}
+
+MixingRamp StereoCreatorAudioProcessor::makeMixingRamp(float overallGain, int numSamples) const
+{
+    const float rampFactor = 1.0f / numSamples;
+    
+    MixingRamp ramp;
+    ramp.start = previousMatrix;
+    ramp.startGain = previousOverallGain;
+    ramp.gainIncrement = (overallGain - previousOverallGain) * rampFactor;
+    ramp.position = 0;
+    for (int out = 0; out < 2; ++out)
+        for (int in = 0; in < 4; ++in)
+            ramp.increment.gains[out][in] = (currentMatrix.gains[out][in] - previousMatrix.gains[out][in]) * rampFactor;
+    
+    return ramp;
+}
+
+template <typename FloatType, int numInputChannels>
+void StereoCreatorAudioProcessor::processTile(FloatType* const* channels, int numSamples, MixingRamp& ramp, BlockLevels& levels) const
 {
-    if (previousGain == currentGain)
+    // every input sample is read once and every output sample written once, levels for the meters are
+    // accumulated on the way
+    const MixingMatrix& start = ramp.start;
+    const MixingMatrix& increment = ramp.increment;
+    
+    FloatType inSquares[4] = { 0, 0, 0, 0 };
+    FloatType inPeaks[4] = { 0, 0, 0, 0 };
+    FloatType outSquares[2] = { 0, 0 };
+    FloatType outPeaks[2] = { 0, 0 };
+    
+    FloatType* left = channels[0];
+    FloatType* right = channels[1];
+    
+    if (numInputChannels == 2)
     {
-        buff->applyGain(bufferChannel, 0, numSamples, currentGain);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float position = (float) (ramp.position + i);
+            const FloatType gain = ramp.startGain + ramp.gainIncrement * position;
+            
+            const FloatType inLeft = left[i];
+            const FloatType inRight = right[i];
+            
+            const FloatType outLeft = gain * ((FloatType) (start.gains[0][0] + increment.gains[0][0] * position) * inLeft + (FloatType) (start.gains[0][1] + increment.gains[0][1] * position) * inRight);
+            const FloatType outRight = gain * ((FloatType) (start.gains[1][0] + increment.gains[1][0] * position) * inLeft + (FloatType) (start.gains[1][1] + increment.gains[1][1] * position) * inRight);
+            left[i] = outLeft;
+            right[i] = outRight;
+            
+            inSquares[0] += inLeft * inLeft;
+            inSquares[1] += inRight * inRight;
+            inPeaks[0] = jmax(inPeaks[0], std::abs(inLeft));
+            inPeaks[1] = jmax(inPeaks[1], std::abs(inRight));
+            outSquares[0] += outLeft * outLeft;
+            outSquares[1] += outRight * outRight;
+            outPeaks[0] = jmax(outPeaks[0], std::abs(outLeft));
+            outPeaks[1] = jmax(outPeaks[1], std::abs(outRight));
+        }
     }
     else
     {
-        buff->applyGainRamp(bufferChannel, 0, numSamples, previousGain, currentGain);
+        FloatType* front = channels[2];
+        FloatType* back = channels[3];
+        
+        // the vectorised kernel takes whole iterations, the scalar loop below does the rest
+        const int first = processTileVectorised(channels, numSamples, ramp, levels);
+        
+        for (int i = first; i < numSamples; ++i)
+        {
+            const float position = (float) (ramp.position + i);
+            const FloatType gain = ramp.startGain + ramp.gainIncrement * position;
+            
+            const FloatType inLeft = left[i];
+            const FloatType inRight = right[i];
+            const FloatType inFront = front[i];
+            const FloatType inBack = back[i];
+            
+            FloatType output[2];
+            for (int out = 0; out < 2; ++out)
+            {
+                FloatType sum = (FloatType) (start.gains[out][0] + increment.gains[out][0] * position) * inLeft;
+                sum += (FloatType) (start.gains[out][1] + increment.gains[out][1] * position) * inRight;
+                sum += (FloatType) (start.gains[out][2] + increment.gains[out][2] * position) * inFront;
+                sum += (FloatType) (start.gains[out][3] + increment.gains[out][3] * position) * inBack;
+                output[out] = gain * sum;
+            }
+            
+            const FloatType outLeft = output[0];
+            const FloatType outRight = output[1];
+            left[i] = outLeft;
+            right[i] = outRight;
+            front[i] = 0;
+            back[i] = 0;
+            
+            inSquares[0] += inLeft * inLeft;
+            inSquares[1] += inRight * inRight;
+            inSquares[2] += inFront * inFront;
+            inSquares[3] += inBack * inBack;
+            inPeaks[0] = jmax(inPeaks[0], std::abs(inLeft));
+            inPeaks[1] = jmax(inPeaks[1], std::abs(inRight));
+            inPeaks[2] = jmax(inPeaks[2], std::abs(inFront));
+            inPeaks[3] = jmax(inPeaks[3], std::abs(inBack));
+            outSquares[0] += outLeft * outLeft;
+            outSquares[1] += outRight * outRight;
+            outPeaks[0] = jmax(outPeaks[0], std::abs(outLeft));
+            outPeaks[1] = jmax(outPeaks[1], std::abs(outRight));
+        }
+    }
+    
+    ramp.position += numSamples;
+    
+    for (int ch = 0; ch < numInputChannels; ++ch)
+    {
+        levels.inputSumOfSquares[ch] += (float) inSquares[ch];
+        levels.inputPeak[ch] = jmax(levels.inputPeak[ch], (float) inPeaks[ch]);
+    }
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        levels.outputSumOfSquares[ch] += (float) outSquares[ch];
+        levels.outputPeak[ch] = jmax(levels.outputPeak[ch], (float) outPeaks[ch]);
+    }
+}
+
+template <typename FloatType, int numInputChannels>
+void StereoCreatorAudioProcessor::processAuxOutputs(AudioBuffer<FloatType>& buffer, int startSample, int numSamples, const FloatType (*inputTile)[tileSize], float bypassAmount)
+{
+    const float rampFactor = 1.0f / numSamples;
+    
+    for (int mode = 0; mode < 5; ++mode)
+    {
+        const int channel = auxOutputChannels[mode];
+        if (channel < 0)
+            continue;
+        
+        // the modes of two OC-818s have no source with one, their buses stay silent
+        if (numInputChannels < 4 && mode + 1 >= eStereoMode::trueMsIdx)
+        {
+            buffer.clear(channel, startSample, numSamples);
+            buffer.clear(channel + 1, startSample, numSamples);
+            continue;
+        }
+        
+        // the compensation gain is part of the matrix, which is ramped from the end of the previous tile
+        MixingMatrix& start = auxPreviousMatrices[mode];
+        MixingMatrix end;
+        calcAuxMixingMatrix(mode + 1, numInputChannels, bypassAmount, end);
+        
+        MixingMatrix increment;
+        for (int out = 0; out < 2; ++out)
+            for (int in = 0; in < 4; ++in)
+                increment.gains[out][in] = (end.gains[out][in] - start.gains[out][in]) * rampFactor;
+        
+        FloatType* outputs[2] = { buffer.getWritePointer(channel, startSample), buffer.getWritePointer(channel + 1, startSample) };
+        
+        for (int out = 0; out < 2; ++out)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float position = (float) i;
+                FloatType sum = 0;
+                for (int in = 0; in < numInputChannels; ++in)
+                    sum += (FloatType) (start.gains[out][in] + increment.gains[out][in] * position) * inputTile[in][i];
+                
+                outputs[out][i] = sum;
+            }
+        }
+        
+        start = end;
+    }
+}
+
+void StereoCreatorAudioProcessor::calcAuxMixingMatrix(int stereoMode, int numInputChannels, float bypassAmount, MixingMatrix& matrix)
+{
+    calcMixingMatrix(stereoMode, numInputChannels, matrix);
+    if (parameters.channelsSwapped)
+        std::swap(matrix.gains[0], matrix.gains[1]);
+    
+    // the single mode outputs fade out with the bypass, instead of passing the input through
+    const float gain = (1.0f - bypassAmount) * auxCompensationGains[stereoMode - 1];
+    for (int out = 0; out < 2; ++out)
+        for (int in = 0; in < 4; ++in)
+            matrix.gains[out][in] *= gain;
+}
+
+int StereoCreatorAudioProcessor::processTileVectorised(float* const* channels, int numSamples, const MixingRamp& ramp, BlockLevels& levels) const
+{
+    if (fourChannelKernel == nullptr)
+        return 0;
+    
+    const int numVectorised = numSamples - numSamples % MixingKernels::framesPerIteration;
+    fourChannelKernel(channels, numVectorised, ramp, levels);
+    return numVectorised;
+}
+
+void StereoCreatorAudioProcessor::resetMixingRamp()
+{
+    crossfadeSamplesRemaining = 0;
+    previousStereoModeIdx = parameters.stereoMode;
+    calcMainMixingMatrix(previousStereoModeIdx, numInputs, previousMatrix);
+    if (parameters.channelsSwapped)
+        std::swap(previousMatrix.gains[0], previousMatrix.gains[1]);
+    previousOverallGain = overallGainSmoothed.getCurrentValue();
+    auxCompensationGains[previousStereoModeIdx - 1] = previousOverallGain;
+}
+
+void StereoCreatorAudioProcessor::setVectorisedKernelsEnabled(bool shouldBeEnabled)
+{
+    fourChannelKernel = shouldBeEnabled ? MixingKernels::getFourChannelKernel() : nullptr;
+    matrixKernel = shouldBeEnabled ? MixingKernels::getMatrixKernel() : nullptr;
+}
+
+bool StereoCreatorAudioProcessor::usesVirtualMicrophones() const
+{
+    return virtualMicsOn->load() >= 0.5f || numInputs > 4 || numMainOutputs > 4;
+}
+
+void StereoCreatorAudioProcessor::startVirtualMicrophones()
+{
+    // the microphones start from what the stereo mode puts out, or from where they are while leaving
+    if (! isLeavingVirtualMicrophones)
+    {
+        virtualMicMatrix = toVirtualMicMatrix(previousMatrix, previousOverallGain);
+        previousVirtualMicMatrix = virtualMicMatrix;
+    }
+    
+    isProcessingVirtualMicrophones = true;
+    isLeavingVirtualMicrophones = false;
+    updateVirtualMicTarget();
+    virtualMicSamplesRemaining = virtualMicRampLength;
+}
+
+void StereoCreatorAudioProcessor::stopVirtualMicrophones()
+{
+    // the stereo mode starts where the microphones end, its output buses fade in from the silence
+    // the microphones leave on them
+    resetMixingRamp();
+    for (auto& matrix : auxPreviousMatrices)
+        matrix = MixingMatrix();
+    
+    virtualMicTarget = toVirtualMicMatrix(previousMatrix, previousOverallGain);
+    virtualMicSamplesRemaining = virtualMicRampLength;
+    isLeavingVirtualMicrophones = true;
+}
+
+void StereoCreatorAudioProcessor::updateVirtualMicTarget()
+{
+    float pairAzimuths[VirtualMicrophones::maxPairs];
+    for (int pair = 0; pair < VirtualMicrophones::maxPairs; ++pair)
+        pairAzimuths[pair] = pairAzimuth[pair]->load();
+    
+    VirtualMicrophone microphones[VirtualMicMatrix::maxOutputs];
+    for (int mic = 0; mic < VirtualMicMatrix::maxOutputs; ++mic)
+    {
+        microphones[mic].sourcePairs = micSourcePairs[jlimit(0, numElementsInArray(micSourcePairs) - 1, (int) micSource[mic]->load())];
+        microphones[mic].pattern = micPattern[mic]->load();
+        microphones[mic].azimuth = micAzimuth[mic]->load();
+    }
+    
+    VirtualMicMatrix target;
+    VirtualMicrophones::calcMatrix(pairAzimuths, numInputs / 2, microphones, numMainOutputs, target);
+    
+    if (std::memcmp(&target, &virtualMicTarget, sizeof(target)) != 0)
+    {
+        virtualMicTarget = target;
+        virtualMicSamplesRemaining = virtualMicRampLength;
+    }
+}
+
+template <typename FloatType>
+void StereoCreatorAudioProcessor::processVirtualMicrophones(AudioBuffer<FloatType>& buffer, int numSamples)
+{
+    const int numInputChannels = jmin(numInputs, VirtualMicMatrix::maxInputs);
+    const int numOutputChannels = jmin(numMainOutputs, VirtualMicMatrix::maxOutputs);
+    
+    if (! isLeavingVirtualMicrophones)
+        updateVirtualMicTarget();
+    blockLevels = BlockLevels();
+    
+    // the microphones overwrite the inputs in place, so every tile of the inputs is copied first
+    FloatType inputTile[VirtualMicMatrix::maxInputs][tileSize];
+    const FloatType* inputs[VirtualMicMatrix::maxInputs];
+    FloatType* outputs[VirtualMicMatrix::maxOutputs];
+    for (int ch = 0; ch < numInputChannels; ++ch)
+        inputs[ch] = inputTile[ch];
+    
+    for (int start = 0; start < numSamples; start += tileSize)
+    {
+        const int tileLength = jmin(tileSize, numSamples - start);
+        
+        if (virtualMicSamplesRemaining > 0)
+        {
+            const float progress = jmin(1.0f, (float) tileLength / virtualMicSamplesRemaining);
+            virtualMicSamplesRemaining = jmax(0, virtualMicSamplesRemaining - tileLength);
+            
+            for (int out = 0; out < numOutputChannels; ++out)
+                for (int in = 0; in < numInputChannels; ++in)
+                    virtualMicMatrix.gains[out][in] += progress * (virtualMicTarget.gains[out][in] - virtualMicMatrix.gains[out][in]);
+        }
+        
+        // while bypassing, the microphones are blended with the passthrough of the inputs
+        VirtualMicMatrix matrix = virtualMicMatrix;
+        const float bypassAmount = bypassSmoothed.skip(tileLength);
+        if (bypassAmount > 0.0f)
+            for (int out = 0; out < numOutputChannels; ++out)
+                for (int in = 0; in < numInputChannels; ++in)
+                    matrix.gains[out][in] = (1.0f - bypassAmount) * matrix.gains[out][in] + (out == in ? bypassAmount : 0.0f);
+        
+        const float rampFactor = 1.0f / tileLength;
+        VirtualMicRamp ramp;
+        ramp.start = previousVirtualMicMatrix;
+        ramp.position = 0;
+        for (int out = 0; out < numOutputChannels; ++out)
+            for (int in = 0; in < numInputChannels; ++in)
+                ramp.increment.gains[out][in] = (matrix.gains[out][in] - previousVirtualMicMatrix.gains[out][in]) * rampFactor;
+        
+        for (int ch = 0; ch < numInputChannels; ++ch)
+            FloatVectorOperations::copy(inputTile[ch], buffer.getReadPointer(ch, start), tileLength);
+        for (int ch = 0; ch < numOutputChannels; ++ch)
+            outputs[ch] = buffer.getWritePointer(ch, start);
+        
+        mixVirtualMicrophones<FloatType>(inputs, numInputChannels, outputs, numOutputChannels, tileLength, ramp);
+        
+        // the meters show the first two OC-818s and the first two microphones
+        for (int ch = 0; ch < jmin(4, numInputChannels); ++ch)
+        {
+            for (int i = 0; i < tileLength; ++i)
+            {
+                const float sample = (float) inputTile[ch][i];
+                blockLevels.inputSumOfSquares[ch] += sample * sample;
+                blockLevels.inputPeak[ch] = jmax(blockLevels.inputPeak[ch], std::abs(sample));
+            }
+        }
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i < tileLength; ++i)
+            {
+                const float sample = (float) outputs[ch][i];
+                blockLevels.outputSumOfSquares[ch] += sample * sample;
+                blockLevels.outputPeak[ch] = jmax(blockLevels.outputPeak[ch], std::abs(sample));
+            }
+        }
+        
+        previousVirtualMicMatrix = matrix;
+    }
+    
+    // the channels behind the main output (inputs beyond it and the buses of the stereo modes) are cleared
+    for (int ch = numOutputChannels; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear(ch, 0, numSamples);
+}
+
+template <typename FloatType>
+void StereoCreatorAudioProcessor::mixVirtualMicrophones(const FloatType* const* inputs, int numInputChannels, FloatType* const* outputs, int numOutputChannels, int numSamples, VirtualMicRamp& ramp) const
+{
+    const VirtualMicMatrix& start = ramp.start;
+    const VirtualMicMatrix& increment = ramp.increment;
+    
+    // the vectorised kernel takes whole iterations, the scalar loop below does the rest
+    const int first = mixVirtualMicrophonesVectorised(inputs, numInputChannels, outputs, numOutputChannels, numSamples, ramp);
+    
+    for (int i = first; i < numSamples; ++i)
+    {
+        const float position = (float) (ramp.position + i);
+        
+        for (int out = 0; out < numOutputChannels; ++out)
+        {
+            FloatType sum = 0;
+            for (int in = 0; in < numInputChannels; ++in)
+                sum += (FloatType) (start.gains[out][in] + increment.gains[out][in] * position) * inputs[in][i];
+            
+            outputs[out][i] = sum;
+        }
+    }
+    
+    ramp.position += numSamples;
+}
+
+int StereoCreatorAudioProcessor::mixVirtualMicrophonesVectorised(const float* const* inputs, int numInputChannels, float* const* outputs, int numOutputChannels, int numSamples, const VirtualMicRamp& ramp) const
+{
+    if (matrixKernel == nullptr)
+        return 0;
+    
+    const int numVectorised = numSamples - numSamples % MixingKernels::framesPerIteration;
+    matrixKernel(inputs, numInputChannels, outputs, numOutputChannels, numVectorised, ramp);
+    return numVectorised;
+}
+
+void StereoCreatorAudioProcessor::updateMeters(int numSamples)
+{
+    // one-pole ballistics, the coefficients depend on the block length
+    const float blockLength = numSamples / (float) currentSampleRate;
+    const float attack = 1.0f - std::exp(- blockLength / meterAttackTime);
+    const float release = 1.0f - std::exp(- blockLength / meterReleaseTime);
+    const float peakRelease = 1.0f - std::exp(- blockLength / peakReleaseTime);
+    
+    auto applyBallistics = [&] (Atomic<float>& meter, Atomic<float>& peakMeter, float rms, float peak)
+    {
+        const float level = meter.get();
+        meter = level + (rms > level ? attack : release) * (rms - level);
+        
+        const float peakLevel = peakMeter.get();
+        peakMeter = peak > peakLevel ? peak : peakLevel + peakRelease * (peak - peakLevel);
+    };
+    
+    for (int ch = 0; ch < 4; ++ch)
+    {
+        const float blockInputRms = std::sqrt(blockLevels.inputSumOfSquares[ch] / numSamples);
+        applyBallistics(inRms[ch], inPeak[ch], blockInputRms, blockLevels.inputPeak[ch]);
+    }
+    
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        blockOutputRms[ch] = std::sqrt(blockLevels.outputSumOfSquares[ch] / numSamples);
+        applyBallistics(outRms[ch], outPeak[ch], blockOutputRms[ch], blockLevels.outputPeak[ch]);
     }
 }
 
@@ -24,6 +24,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MixingKernels.h"
+#include "LoudnessAnalyser.h"
+#include "VirtualMicrophones.h"
 
 enum eStereoMode
 {
@@ -40,10 +43,36 @@ enum eCurrentActiveLayer
     layerB = 2
 };
 
+// parameter values used by the audio thread, loaded once per block
+struct ParameterSnapshot
+{
+    int stereoMode;
+    bool channelsSwapped;
+    bool calcCompensationGain;
+    float midGain;
+    float sideGain;
+    float pseudoStereoPattern;
+    float msMidPattern;
+    float trueStereoPattern;
+    float compensationGain;
+    
+    bool followLoudness;
+    float followRiseTime;
+    float followFallTime;
+    float followMaxSlew;
+    
+    float xyAngle;
+    float xyEightRotationGainFront;
+    float xyEightRotationGainLeft;
+    float blumleinRotation;
+    float blumleinEightRotationGainFront;
+    float blumleinEightRotationGainLeft;
+};
+
 //==============================================================================
 /**
 */
-class StereoCreatorAudioProcessor  : public juce::AudioProcessor, public AudioProcessorValueTreeState::Listener
+class StereoCreatorAudioProcessor  : public juce::AudioProcessor, public ChangeBroadcaster, private AsyncUpdater
 {
 public:
     //==============================================================================
@@ -59,6 +88,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -84,24 +117,99 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
     
     //==============================================================================
-    void parameterChanged (const String &parameterID, float newValue) override;
-
     int getStereoModeIdx() { return  (stereoModeIdx->load()); }
+    // a change message is sent when the number of input channels changes
     int getNumInpCh() { return numInputs; }
-    void getXyAngleRelatedGains(float currentAngle);
-    void getBlumleinRotationGains (float currentRotation);
     void changeAbLayerState();
     void setAbLayer(int desiredLayer);
     
-    void applyGainWithRamp (float previousGain, float currentGain, AudioBuffer<float>* buff, int bufferChannel, int numSamples);
-    bool compensationGainCalcOver() { return autoLevelsOn->load() > 0.5f; }
+    // lets the benchmark compare the vectorised kernels with the scalar path, not while processing
+    void setVectorisedKernelsEnabled (bool shouldBeEnabled);
     
 //    Atomic<bool> wrongBusConfiguration = false;
     
+    // meter levels with attack/release ballistics applied
     Atomic<float> inRms[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
     Atomic<float> outRms[2] = { 0.0f, 0.0f};
+    Atomic<float> inPeak[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    Atomic<float> outPeak[2] = { 0.0f, 0.0f};
     
 private:
+    // publishes calculated compensation gains to the host from the message thread
+    void handleAsyncUpdate() override;
+    
+    void loadParameterSnapshot();
+    void getXyAngleRelatedGains(float currentAngle);
+    void getBlumleinRotationGains (float currentRotation);
+    void calcMixingMatrix (int stereoMode, int numInputChannels, MixingMatrix& matrix);
+    // the main output passes left/right through in the pseudo modes with two OC-818s, like it always did
+    void calcMainMixingMatrix (int stereoMode, int numInputChannels, MixingMatrix& matrix);
+    
+    // float and double buffers share everything but the sample type
+    template <typename FloatType>
+    void processBuffer (AudioBuffer<FloatType>& buffer, bool bypassed);
+    
+    // one specialised kernel per sample type, stereo mode, number of input channels and channel swap
+    template <typename FloatType>
+    using ProcessFunction = void (StereoCreatorAudioProcessor::*) (AudioBuffer<FloatType>&, int);
+    
+    template <typename FloatType>
+    static ProcessFunction<FloatType> getProcessFunction (int stereoMode, int numInputChannels, bool channelsSwapped);
+    
+    template <typename FloatType, int stereoMode, int numInputChannels, bool channelsSwapped>
+    void process (AudioBuffer<FloatType>& buffer, int numSamples);
+    
+    // ramp from previousMatrix/previousOverallGain to currentMatrix/overallGain over numSamples
+    MixingRamp makeMixingRamp (float overallGain, int numSamples) const;
+    
+    // the host block is processed in tiles of at most tileSize samples, the smoothed parameters
+    // are advanced once per tile
+    static constexpr int tileSize = 64;
+    void advanceParameterSmoothing (int numSamples);
+    
+    // lets all smoothers, the mode crossfade and the matrix ramp jump to their targets
+    void skipRamps();
+    // lets the matrix ramp of the stereo modes start from the current parameters
+    void resetMixingRamp();
+    
+    template <typename FloatType>
+    bool isSilent (const AudioBuffer<FloatType>& buffer, int numChannels) const;
+    
+    template <typename FloatType, int numInputChannels>
+    void processTile (FloatType* const* channels, int numSamples, MixingRamp& ramp, BlockLevels& levels) const;
+    
+    // renders every mode to its own stereo output bus, if enabled, from a copy of the tile's input
+    template <typename FloatType, int numInputChannels>
+    void processAuxOutputs (AudioBuffer<FloatType>& buffer, int startSample, int numSamples, const FloatType (*inputTile)[tileSize], float bypassAmount);
+    void calcAuxMixingMatrix (int stereoMode, int numInputChannels, float bypassAmount, MixingMatrix& matrix);
+    
+    // hands whole iterations of a four channel tile to the vectorised kernel, returns the number of samples done
+    int processTileVectorised (float* const* channels, int numSamples, const MixingRamp& ramp, BlockLevels& levels) const;
+    int processTileVectorised (double* const*, int, const MixingRamp&, BlockLevels&) const { return 0; }
+    
+    // the virtual microphones replace the stereo modes when switched on, or when the inputs or the main
+    // output have more channels than the modes use. Every channel of the main output is one microphone
+    bool usesVirtualMicrophones() const;
+    void updateVirtualMicTarget();
+    
+    // switching between the stereo modes and the microphones is ramped on the microphone matrix, which can
+    // hold the output of a stereo mode as well. After switching off, the microphones move to the stereo
+    // mode's output before the stereo path takes over
+    void startVirtualMicrophones();
+    void stopVirtualMicrophones();
+    
+    template <typename FloatType>
+    void processVirtualMicrophones (AudioBuffer<FloatType>& buffer, int numSamples);
+    
+    template <typename FloatType>
+    void mixVirtualMicrophones (const FloatType* const* inputs, int numInputChannels, FloatType* const* outputs, int numOutputChannels, int numSamples, VirtualMicRamp& ramp) const;
+    
+    // hands whole iterations of a tile to the vectorised matrix kernel, returns the number of samples done
+    int mixVirtualMicrophonesVectorised (const float* const* inputs, int numInputChannels, float* const* outputs, int numOutputChannels, int numSamples, const VirtualMicRamp& ramp) const;
+    int mixVirtualMicrophonesVectorised (const double* const*, int, double* const*, int, int, const VirtualMicRamp&) const { return 0; }
+    
+    void updateMeters (int numSamples);
+    
     AudioProcessorValueTreeState params;
     
     // AB layer handling
@@ -120,46 +228,124 @@ private:
     
     std::atomic<float>* channelSwitchOn;
     std::atomic<float>* autoLevelsOn;
+    std::atomic<float>* msMidGain;
+    std::atomic<float>* msSideGain;
+    std::atomic<float>* pseudoStPattern;
+    std::atomic<float>* msMidPattern;
+    std::atomic<float>* trueStXyPattern;
+    std::atomic<float>* trueStXyAngle;
+    std::atomic<float>* blumleinRot;
+    std::atomic<float>* compensationGain[5];
+    std::atomic<float>* followLoudnessOn;
+    std::atomic<float>* followRiseTime;
+    std::atomic<float>* followFallTime;
+    std::atomic<float>* followMaxSlew;
+    std::atomic<float>* virtualMicsOn;
+    std::atomic<float>* pairAzimuth[VirtualMicrophones::maxPairs];
+    std::atomic<float>* micSource[VirtualMicMatrix::maxOutputs];
+    std::atomic<float>* micPattern[VirtualMicMatrix::maxOutputs];
+    std::atomic<float>* micAzimuth[VirtualMicMatrix::maxOutputs];
+    
+    RangedAudioParameter* calcCompGainParam;
+    RangedAudioParameter* compensationGainParam[5];
+    
+    ParameterSnapshot parameters;
+    
+    // the matrix parameters and the overall gain ramp to new values in a fixed time, whatever the block size
+    const double parameterSmoothingTime = 0.02;
+    SmoothedValue<float> midGainSmoothed;
+    SmoothedValue<float> sideGainSmoothed;
+    SmoothedValue<float> pseudoStereoPatternSmoothed;
+    SmoothedValue<float> msMidPatternSmoothed;
+    SmoothedValue<float> trueStereoPatternSmoothed;
+    SmoothedValue<float> xyAngleSmoothed;
+    SmoothedValue<float> blumleinRotationSmoothed;
+    SmoothedValue<float> overallGainSmoothed;
+    
+    // 0 when processing, 1 when bypassed: left/right are passed through and front/back cleared
+    SmoothedValue<float> bypassSmoothed;
+    
+    SmoothedValue<float>* const smoothers[9] = { &midGainSmoothed, &sideGainSmoothed, &pseudoStereoPatternSmoothed, &msMidPatternSmoothed, &trueStereoPatternSmoothed, &xyAngleSmoothed, &blumleinRotationSmoothed, &overallGainSmoothed, &bypassSmoothed };
+    
+    // input blocks below this magnitude (-120 dB) are treated as silence and not processed
+    const float silenceThreshold = 0.000001f;
     
     Atomic<bool> isPlaying = false;
     
-    AudioBuffer<float> omniEightLrBuffer; 
-    AudioBuffer<float> omniEightFbBuffer;
-    AudioBuffer<float> msMidBuffer;
-    AudioBuffer<float> msLeftRightBuffer;
-    AudioBuffer<float> chSwitchBuffer;
-    AudioBuffer<float> passThroughLeftRightBuffer;
-    AudioBuffer<float> rotatedEightLeftRightBuffer;
-    AudioBuffer<float> xyLeftRightBuffer;
-    AudioBuffer<float> blumleinLeftRightBuffer;
-    
-    float currentXyEightRotationGainFront;
-    float currentXyEightRotationGainLeft;
-    float previousXyEightRotationGainFront;
-    float previousXyEightRotationGainLeft;
-    
-    float currentBlumleinEightRotationGainFront;
-    float currentBlumleinEightRotationGainLeft;
-    float previousBlumleinEightRotationGainFront;
-    float previousBlumleinEightRotationGainLeft;
-    
-    float previousCompensationGain[5];
-    int counter = 0;
+    MixingMatrix previousMatrix;
+    MixingMatrix currentMatrix;
+    
+    // vectorised kernels for the four channel modes and the virtual microphones, picked for the CPU at construction
+    MixingKernels::FourChannelKernel fourChannelKernel;
+    MixingKernels::MatrixKernel matrixKernel;
+    
+    // a mode change crossfades from the old mode's matrix to the new one in a fixed time. Every mode mixes
+    // the same inputs linearly, so this equals crossfading the outputs of both modes at the cost of one
+    const double modeCrossfadeTime = 0.01;
+    MixingMatrix crossfadeSourceMatrix;
+    int crossfadeLength = 0;
+    int crossfadeSamplesRemaining = 0;
+    
+    // first buffer channel of each mode's output bus, -1 if the bus is disabled
+    int auxOutputChannels[5] = { -1, -1, -1, -1, -1 };
+    int numAuxOutputs = 0;
+    // the compensation gains of the single modes, the active mode's one is the smoothed gain of the main output
+    float auxCompensationGains[5];
+    MixingMatrix auxPreviousMatrices[5];
+    
+    // the virtual microphone matrix moves linearly to a changed target in parameterSmoothingTime.
+    // previousVirtualMicMatrix is the one applied at the end of the last tile, including the bypass
+    int numMainOutputs = 2;
+    VirtualMicMatrix virtualMicTarget {};
+    VirtualMicMatrix virtualMicMatrix {};
+    VirtualMicMatrix previousVirtualMicMatrix {};
+    int virtualMicRampLength = 0;
+    int virtualMicSamplesRemaining = 0;
+    bool isProcessingVirtualMicrophones = false;
+    bool isLeavingVirtualMicrophones = false;
+    
+    BlockLevels blockLevels;
+    float blockOutputRms[2] = { 0.0f, 0.0f };
+    const float meterAttackTime = 0.01f;
+    const float meterReleaseTime = 0.3f;
+    const float peakReleaseTime = 1.5f;
+    int previousStereoModeIdx = 0;
+    
+    // calculated compensation gains waiting to be published by handleAsyncUpdate
+    struct CompensationGainResult
+    {
+        int stereoMode;
+        float gainInDecibels;
+    };
+    
+    AbstractFifo compensationGainFifo { 8 };
+    CompensationGainResult compensationGainResults[8];
+    std::atomic<bool> isCompensationGainPending { false };
+    float pendingCompensationGains[5];
+    
+    // every output is a linear mix of the inputs, so its loudness follows from the K-weighted input covariance
+    // and the mixing matrix. The covariance is gated like ITU-R BS.1770 over the last secondsToAverage.
+    // The gains of all modes are calculated once per measurement, not updated continuously from a running
+    // covariance: an ungated running average follows rumble and pauses, and the follow mode below already
+    // tracks the latest measurement for the active mode
+    float calcCompensationGainInDecibels (int stereoMode, const InputCovariance& inputCovariance);
+    void calcCompensationGains (const InputCovariance& inputCovariance);
+    
+    LoudnessAnalyser loudnessAnalyser;
     float secondsToAverage = 1.5f;
-    int blocksToAverage;
-    float inputGainMean = 0.000001f;
-    float outGainMean = 0.000001f;
-    
-    float previousMidGain;
-    float previousSideGain;
-    float previousPseudoStereoPattern;
-    float previousMsMidPattern;
-    float previousTrueStereoPattern;
+    
+    // the follow mode moves the gain towards the calculated one with the rise/fall time constants, limited
+    // to the maximum slew. The followed gain is only applied, the parameter of the mode isn't changed
+    float followLoudness (int numSamples);
+    
+    int followedStereoMode = 0;
+    float followedGainInDecibels = 0.0f;
+    float followTargetInDecibels = 0.0f;
+    
     float previousOverallGain;
     
     float currentOverallGain;
     
-    int currentBlockSize;
     double currentSampleRate;
     
     
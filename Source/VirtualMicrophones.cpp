@@ -0,0 +1,94 @@
+/*
+ ==============================================================================
+ VirtualMicrophones.cpp
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include "VirtualMicrophones.h"
+
+void VirtualMicrophones::calcMatrix (const float* pairAzimuths, int numPairs, const VirtualMicrophone* microphones, int numMicrophones, VirtualMicMatrix& matrix)
+{
+    for (int out = 0; out < VirtualMicMatrix::maxOutputs; ++out)
+        for (int in = 0; in < VirtualMicMatrix::maxInputs; ++in)
+            matrix.gains[out][in] = 0.0f;
+
+    const int availablePairs = (1 << jlimit (0, maxPairs, numPairs)) - 1;
+
+    for (int out = 0; out < jmin (numMicrophones, VirtualMicMatrix::maxOutputs); ++out)
+    {
+        const VirtualMicrophone& microphone = microphones[out];
+        const int pairs = microphone.sourcePairs & availablePairs;
+
+        // axes of the eights and their Gram matrix
+        float axisX[maxPairs], axisY[maxPairs];
+        float gramXX = 0.0f, gramXY = 0.0f, gramYY = 0.0f;
+        int numUsedPairs = 0;
+
+        for (int pair = 0; pair < maxPairs; ++pair)
+        {
+            if ((pairs & (1 << pair)) == 0)
+                continue;
+
+            const float angle = degreesToRadians (pairAzimuths[pair]);
+            axisX[pair] = std::cos (angle);
+            axisY[pair] = std::sin (angle);
+            gramXX += axisX[pair] * axisX[pair];
+            gramXY += axisX[pair] * axisY[pair];
+            gramYY += axisY[pair] * axisY[pair];
+            ++numUsedPairs;
+        }
+
+        if (numUsedPairs == 0)
+            continue;
+
+        // the eight pointing at the azimuth is the smallest combination of the pairs' eights that gives it.
+        // If all axes are parallel it can't be steered, the projection onto the axis is used instead
+        const float angle = degreesToRadians (microphone.azimuth);
+        float targetX = std::cos (angle);
+        float targetY = std::sin (angle);
+
+        const float determinant = gramXX * gramYY - gramXY * gramXY;
+        if (determinant > 0.001f)
+        {
+            const float x = (gramYY * targetX - gramXY * targetY) / determinant;
+            const float y = (gramXX * targetY - gramXY * targetX) / determinant;
+            targetX = x;
+            targetY = y;
+        }
+        else
+        {
+            targetX /= numUsedPairs;
+            targetY /= numUsedPairs;
+        }
+
+        // (1 - pattern) * omni + pattern * eight, the omni is the mean of the pairs' omnis
+        const float omni = (1.0f - microphone.pattern) / numUsedPairs;
+
+        for (int pair = 0; pair < maxPairs; ++pair)
+        {
+            if ((pairs & (1 << pair)) == 0)
+                continue;
+
+            const float eight = microphone.pattern * (axisX[pair] * targetX + axisY[pair] * targetY);
+            matrix.gains[out][2 * pair] = omni + eight;
+            matrix.gains[out][2 * pair + 1] = omni - eight;
+        }
+    }
+}
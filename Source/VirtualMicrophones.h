@@ -0,0 +1,50 @@
+/*
+ ==============================================================================
+ VirtualMicrophones.h
+ Author: Simon Beck
+
+ Copyright (c) 2019 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "MixingKernels.h"
+
+// A first-order virtual microphone made from one or more OC-818s. Each OC-818 is a pair of back-to-back
+// cardioid capsules: their sum is an omni, their difference a figure-of-eight along the pair's axis.
+struct VirtualMicrophone
+{
+    // bit mask of the OC-818s used. With more than one, they have to be coincident (e.g. crossed at 90
+    // degrees), their eights are then combined into one pointing at the azimuth
+    int sourcePairs;
+
+    // 0 is omni, 0.5 cardioid and 1 figure-of-eight, like the patterns of the stereo modes
+    float pattern;
+
+    // degrees, counterclockwise from the front
+    float azimuth;
+};
+
+namespace VirtualMicrophones
+{
+    const int maxPairs = VirtualMicMatrix::maxInputs / 2;
+
+    // the first capsule of pair k is input 2k and points at pairAzimuths[k], the second one is input 2k + 1.
+    // Outputs beyond numMicrophones and pairs that aren't there give silence
+    void calcMatrix (const float* pairAzimuths, int numPairs, const VirtualMicrophone* microphones, int numMicrophones, VirtualMicMatrix& matrix);
+}
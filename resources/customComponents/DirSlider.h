@@ -89,12 +89,7 @@ public:
         activePatternPath(-1.0f),
         slider(newSlider)
         {
-            bCardPath.loadPathFromData (bCardData, sizeof (bCardData));
-            cardPath.loadPathFromData (cardData, sizeof (cardData));
-            sCardPath.loadPathFromData (sCardData, sizeof (sCardData));
-            hCardPath.loadPathFromData (hCardData, sizeof (hCardData));
-            eightPath.loadPathFromData (eightData, sizeof (eightData));
-            omniPath.loadPathFromData (omniData, sizeof (omniData));
+            // the pattern paths are set by the editor from the shared PatternPaths
 //            revCardPath.loadPathFromData (cardData, sizeof (cardData));
 //            revCardPath.applyTransform (AffineTransform::rotation(M_PI));
 //            dirStripTop.setPatternPathsAndFactors(bCardPath, hCardPath, bCardFact, hCardFact);
@@ -186,12 +181,6 @@ public:
 //        float patternFactorBottomL;
 //        float patternFactorBottomR;
         
-        Path bCardPath;
-        Path cardPath;
-        Path sCardPath;
-        Path hCardPath;
-        Path eightPath;
-        Path omniPath;
 //        Path revCardPath;
         
         Path leftPath;
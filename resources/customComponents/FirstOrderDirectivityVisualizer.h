@@ -70,6 +70,7 @@ public:
         soloActive = false;
         rotation = 0.0f;
         patternAlpha = 1.0f;
+        dirWeight = 0.0f;
         
         colour = Colour(0xFFD0011B);
         
@@ -96,6 +97,7 @@ public:
         subGrid.addPath(line, AffineTransform().rotation(0.5f * M_PI));
         subGrid.addPath(line, AffineTransform().rotation(0.75f * M_PI));
 
+        updatePatternPath();
     }
 
     ~FirstOrderDirectivityVisualizer()
@@ -104,43 +106,16 @@ public:
 
     void paint (Graphics& g) override
     {
-        Path path;
-        path = grid;
-        path.applyTransform(transform);
-        g.setColour (Colours::skyblue.withMultipliedAlpha(0.05f));
-        g.fillPath(path);
-//        g.setColour (Colours::white.withMultipliedAlpha(!isActive ? 0.5f : calcAlpha()));
-        g.strokePath(path, PathStrokeType(1.0f));
+        // the grid only changes with the size, it is rendered once per size and pixel scale
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (gridImage.isNull() || gridImageScale != scale)
+            renderGridImage (scale);
 
-        path = subGrid;
-        path.applyTransform(transform);
-        g.setColour (Colours::skyblue.withMultipliedAlpha(0.15f));
-        g.strokePath(path, PathStrokeType(0.5f));
+        g.drawImageTransformed (gridImage, AffineTransform::scale (1.0f / gridImageScale));
 
         // draw directivity
         g.setColour (colour.withMultipliedAlpha(!isActive ? 0.0f : patternAlpha));
-        path.clear();
-        
-        int idx=0;
-        for (int phi = -180; phi <= 180; phi += degStep)
-        {
-            float phiInRad = (float) phi * deg2rad + rotation;
-            float gainLin = std::abs((1 - std::abs (dirWeight)) + dirWeight * std::cos(phiInRad));
-            int dbMin = 25;
-            float gainDb = 20 * std::log10 (std::max (gainLin, static_cast<float> (std::pow (10, -dbMin / 20.0f))));
-            float effGain = std::max (std::abs ((gainDb + dbMin) / dbMin), 0.01f);
-            Point<float> point = effGain * pointsOnCircle[idx];
-            
-            if (phi == -180)
-                path.startNewSubPath(point);
-            else
-                path.lineTo(point);
-            ++idx;
-        }
-
-        path.closeSubPath();
-        path.applyTransform(transform);
-        g.strokePath(path, PathStrokeType(2.0f));
+        g.strokePath(transformedPatternPath, PathStrokeType(2.0f));
     }
 
     void resized() override
@@ -160,11 +135,18 @@ public:
 
 
         plotArea = bounds;
+
+        gridImage = Image();
+        updateTransformedPatternPath();
     }
     
     void setDirWeight(float weight)
     {
+        if (weight == dirWeight)
+            return;
+
         dirWeight = weight;
+        updatePatternPath();
         repaint();
     }
     
@@ -185,7 +167,11 @@ public:
     
     void setPatternAlpha(float newAlpha)
     {
+        if (newAlpha == patternAlpha)
+            return;
+
         patternAlpha = newAlpha;
+        repaint();
     }
     
 //    float calcAlpha()
@@ -216,12 +202,76 @@ public:
     
     void setPatternRotation (float degrees)
     {
-        rotation = degrees * deg2rad;
+        const float newRotation = degrees * deg2rad;
+        if (newRotation == rotation)
+            return;
+
+        rotation = newRotation;
+        updateTransformedPatternPath();
+        repaint();
     }
 
 private:
+    void renderGridImage (float scale)
+    {
+        gridImageScale = scale;
+        gridImage = Image (Image::ARGB, jmax (1, roundToInt (getWidth() * scale)), jmax (1, roundToInt (getHeight() * scale)), true);
+
+        Graphics g (gridImage);
+        g.addTransform (AffineTransform::scale (scale));
+
+        Path path;
+        path = grid;
+        path.applyTransform(transform);
+        g.setColour (Colours::skyblue.withMultipliedAlpha(0.05f));
+        g.fillPath(path);
+        g.strokePath(path, PathStrokeType(1.0f));
+
+        path = subGrid;
+        path.applyTransform(transform);
+        g.setColour (Colours::skyblue.withMultipliedAlpha(0.15f));
+        g.strokePath(path, PathStrokeType(0.5f));
+    }
+
+    // the dB-scaled pattern in unit coordinates without rotation, only depends on the weight
+    void updatePatternPath()
+    {
+        patternPath.clear();
+
+        int idx=0;
+        for (int phi = -180; phi <= 180; phi += degStep)
+        {
+            float phiInRad = (float) phi * deg2rad;
+            float gainLin = std::abs((1 - std::abs (dirWeight)) + dirWeight * std::cos(phiInRad));
+            int dbMin = 25;
+            float gainDb = 20 * std::log10 (std::max (gainLin, static_cast<float> (std::pow (10, -dbMin / 20.0f))));
+            float effGain = std::max (std::abs ((gainDb + dbMin) / dbMin), 0.01f);
+            Point<float> point = effGain * pointsOnCircle[idx];
+
+            if (phi == -180)
+                patternPath.startNewSubPath(point);
+            else
+                patternPath.lineTo(point);
+            ++idx;
+        }
+
+        patternPath.closeSubPath();
+        updateTransformedPatternPath();
+    }
+
+    // the rotation turns the pattern against the angle its gains are evaluated at
+    void updateTransformedPatternPath()
+    {
+        transformedPatternPath = patternPath;
+        transformedPatternPath.applyTransform(AffineTransform::rotation(-rotation).followedBy(transform));
+    }
+
     Path grid;
     Path subGrid;
+    Image gridImage;
+    float gridImageScale = 1.0f;
+    Path patternPath;
+    Path transformedPatternPath;
     AffineTransform transform;
     Rectangle<int> plotArea;
     float dirWeight;
@@ -522,3 +522,25 @@ static const unsigned char arrayPng2Ch[] =
     221,98,56,112,187,146,88,52,108,206,58,14,254,101,71,126,174,108,132,4,180,8,16,0,170,152,72,8,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,
     1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,1,2,64,21,
     1,2,64,21,1,2,64,21,1,2,192,242,82,74,255,31,78,103,45,136,16,139,147,197,0,0,0,0,73,69,78,68,174,66,96,130,0,0 };
+
+//==============================================================================
+// the polar pattern paths, loaded once and shared by all editors and sliders via SharedResourcePointer
+struct PatternPaths
+{
+    PatternPaths()
+    {
+        bCardPath.loadPathFromData (bCardData, sizeof (bCardData));
+        cardPath.loadPathFromData (cardData, sizeof (cardData));
+        sCardPath.loadPathFromData (sCardData, sizeof (sCardData));
+        hCardPath.loadPathFromData (hCardData, sizeof (hCardData));
+        eightPath.loadPathFromData (eightData, sizeof (eightData));
+        omniPath.loadPathFromData (omniData, sizeof (omniData));
+    }
+
+    Path bCardPath;
+    Path cardPath;
+    Path sCardPath;
+    Path hCardPath;
+    Path eightPath;
+    Path omniPath;
+};
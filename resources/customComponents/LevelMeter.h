@@ -47,7 +47,6 @@ public:
         g.setFont (labelHeight);
         g.drawText(labelText, labelBounds, Justification::centred);
         
-        float labelMargin = 6.0f;
         bounds.removeFromBottom(labelMargin);
         g.setColour(Colours::black);
         g.drawRoundedRectangle(bounds.toFloat(), 4.0f, 2.0f);
@@ -56,17 +55,41 @@ public:
         auto innerBounds = bounds.reduced(1).toFloat();
         auto newHeight = innerBounds.getHeight() * (1.0f - normalizedMeterHeight);
         g.fillRoundedRectangle(innerBounds.withTop(newHeight), 2.0f);
+        
+        if (normalizedPeakHeight > 0.0f)
+        {
+            auto peakHeight = innerBounds.getY() + innerBounds.getHeight() * (1.0f - normalizedPeakHeight);
+            g.setColour(colour.brighter());
+            g.fillRect(innerBounds.getX(), peakHeight, innerBounds.getWidth(), 1.0f);
+        }
     }
 
     void resized() override
     {
     }
     
-    void setLevel(float newLevel)
+    // repaints only if the bar or the peak line moves by at least one pixel
+    void setLevels(float newLevel, float newPeak)
     {
+        setPeakLevel(newPeak);
         float levelDb = Decibels::gainToDecibels(newLevel, minDb);
         normalizedMeterHeight = (minDb - levelDb) / minDb;
-        repaint();
+        
+        const float meterHeight = getHeight() - getWidth() - labelMargin - 2.0f;
+        const int meterPixels = roundToInt(normalizedMeterHeight * meterHeight);
+        const int peakPixels = roundToInt(normalizedPeakHeight * meterHeight);
+        if (meterPixels != paintedMeterPixels || peakPixels != paintedPeakPixels)
+        {
+            paintedMeterPixels = meterPixels;
+            paintedPeakPixels = peakPixels;
+            repaint();
+        }
+    }
+    
+    void setPeakLevel(float newPeak)
+    {
+        float peakDb = Decibels::gainToDecibels(newPeak, minDb);
+        normalizedPeakHeight = (minDb - peakDb) / minDb;
     }
     
     void setColour(Colour newColour)
@@ -82,9 +105,13 @@ public:
     
 private:
     float normalizedMeterHeight = 0.0f;
+    float normalizedPeakHeight = 0.0f;
     Colour colour;
     juce::String labelText = "";
     const float minDb = -60.0f;
+    const float labelMargin = 6.0f;
+    int paintedMeterPixels = -1;
+    int paintedPeakPixels = -1;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
 };
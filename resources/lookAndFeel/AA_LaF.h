@@ -78,12 +78,28 @@ public:
     //float sliderThumbDiameter = 14.0f;
     float sliderBarSize = 8.0f;
 
+    // the typefaces are created once and shared by all LaF instances via SharedResourcePointer
+    struct Typefaces
+    {
+        Typefaces()
+        {
+            aaLight = Typeface::createSystemTypefaceFor(BinaryFonts::NunitoSansLight_ttf, BinaryFonts::NunitoSansLight_ttfSize);
+            aaMedium = Typeface::createSystemTypefaceFor(BinaryFonts::NunitoSansRegular_ttf, BinaryFonts::NunitoSansRegular_ttfSize);
+            aaRegular = Typeface::createSystemTypefaceFor(BinaryFonts::NunitoSansSemiBold_ttf, BinaryFonts::NunitoSansSemiBold_ttfSize);
+            terminator = Typeface::createSystemTypefaceFor(BinaryFonts::terminator_ttf, BinaryFonts::terminator_ttfSize);
+        }
+
+        Typeface::Ptr aaLight, aaRegular, aaMedium, terminator;
+    };
+
+    SharedResourcePointer<Typefaces> typefaces;
+
     LaF()
     {
-        aaLight = Typeface::createSystemTypefaceFor(BinaryFonts::NunitoSansLight_ttf, BinaryFonts::NunitoSansLight_ttfSize);
-        aaMedium = Typeface::createSystemTypefaceFor(BinaryFonts::NunitoSansRegular_ttf, BinaryFonts::NunitoSansRegular_ttfSize);
-        aaRegular = Typeface::createSystemTypefaceFor(BinaryFonts::NunitoSansSemiBold_ttf, BinaryFonts::NunitoSansSemiBold_ttfSize);
-        terminator = Typeface::createSystemTypefaceFor(BinaryFonts::terminator_ttf, BinaryFonts::terminator_ttfSize);
+        aaLight = typefaces->aaLight;
+        aaMedium = typefaces->aaMedium;
+        aaRegular = typefaces->aaRegular;
+        terminator = typefaces->terminator;
 
         setColour (Slider::rotarySliderFillColourId, Colours::black);
         setColour (Slider::thumbColourId, Colour (0xCCFFFFFF));